@@ -0,0 +1,278 @@
+// standalone benchmark driver for the R-independent core of the kernels
+// (inst/include/DiscreteFWER); it generates synthetic families of discrete
+// p-value CDFs and times the computations of the four kernels in both
+// dependence modes
+//
+// build (from the package root):
+//   g++ -O2 -std=c++11 -fopenmp -Iinst/include bench/bench_kernels.cpp -o bench_kernels
+//
+// usage:
+//   bench_kernels [--format csv|json] [--reps N] [--threads T] [--seed S]
+//                 [--quick]
+//
+// the results are written to stdout, one record per kernel, dependence mode
+// and family; each record is the complete computation of the kernel, and the
+// critical value kernels reuse one workspace across repetitions like the R
+// kernels
+
+#include <DiscreteFWER/procedures.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+using namespace DiscreteFWER;
+
+// type of the supports of the generated CDFs
+enum support_type { FISHER, BINOMIAL, POISSON };
+static const char* type_names[] = {"fisher", "binomial", "poisson"};
+
+// configuration of a synthetic family
+struct bench_config {
+  support_type type;
+  // number of tests
+  int numTests;
+  // approximate length of the supports
+  int length;
+  // fraction of tests whose CDF equals the one of another test
+  double duplication;
+  // probability that a p-value equals the one of another test with the same
+  // CDF
+  double ties;
+};
+
+// synthetic family with sorted p-values and their CDF indices
+struct bench_family {
+  std::vector<std::vector<double> > cdfs;
+  std::vector<std::vector<int> > indices;
+  std::vector<double> sorted_pv;
+
+  // R-independent view of the family
+  CDF_family view() const {
+    CDF_family fam((int)cdfs.size());
+    for(int i = 0; i < fam.numCDF; i++) {
+      fam.vals[i] = cdfs[i].data();
+      fam.lens[i] = CDF_length(cdfs[i].data(), (int)cdfs[i].size());
+      fam.counts[i] = (int)indices[i].size();
+      fam.indices[i] = indices[i].data();
+    }
+    return fam;
+  }
+};
+
+// support of a one-sided test, i.e. the upper tail probabilities P(X >= x),
+// given the log-probabilities of X = 0, 1, ...
+static std::vector<double> tail_support(const std::vector<double> &logpmf) {
+  double mx = *std::max_element(logpmf.begin(), logpmf.end());
+  std::vector<double> pmf(logpmf.size());
+  double total = 0;
+  for(size_t x = 0; x < pmf.size(); x++) total += pmf[x] = std::exp(logpmf[x] - mx);
+  std::vector<double> support;
+  double tail = 0;
+  for(size_t x = pmf.size(); x-- > 1;) {
+    tail += pmf[x] / total;
+    // rounding errors must not produce values >= 1 before the last one
+    if(tail >= 1) break;
+    if(tail > 0 && (support.empty() || tail > support.back())) support.push_back(tail);
+  }
+  support.push_back(1.0);
+  return support;
+}
+
+static double log_choose(const int n, const int k) {
+  return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+}
+
+// support of a CDF of the given type with roughly 'length' values
+static std::vector<double> random_support(const support_type type, const int length, std::mt19937 &rng) {
+  std::uniform_int_distribution<int> size(std::max(1, length / 2), std::max(1, 2 * length));
+  std::uniform_real_distribution<double> unif(0.05, 0.95);
+  std::vector<double> logpmf;
+  if(type == FISHER) {
+    // first cell of a 2x2 table with row sums n1, n2 and first column sum k
+    int n1 = size(rng), n2 = size(rng);
+    int k = std::max(1, (int)(unif(rng) * (n1 + n2)));
+    for(int x = std::max(0, k - n2); x <= std::min(k, n1); x++)
+      logpmf.push_back(log_choose(n1, x) + log_choose(n2, k - x));
+  } else if(type == BINOMIAL) {
+    int n = size(rng);
+    double p = unif(rng);
+    for(int x = 0; x <= n; x++)
+      logpmf.push_back(log_choose(n, x) + x * std::log(p) + (n - x) * std::log1p(-p));
+  } else {
+    // Poisson distribution, truncated where its tail becomes negligible
+    double lambda = size(rng) / 4.0 + 1;
+    int upper = (int)(lambda + 12 * std::sqrt(lambda) + 10);
+    for(int x = 0; x <= upper; x++)
+      logpmf.push_back(x * std::log(lambda) - lambda - std::lgamma(x + 1.0));
+  }
+  return tail_support(logpmf);
+}
+
+static bench_family generate(const bench_config &cfg, std::mt19937 &rng) {
+  int numCDF = std::max(1, (int)std::lround(cfg.numTests * (1 - cfg.duplication)));
+  std::vector<std::vector<double> > cdfs(numCDF);
+  for(int i = 0; i < numCDF; i++) cdfs[i] = random_support(cfg.type, cfg.length, rng);
+
+  // CDF of each test (each CDF belongs to at least one test) and observed
+  // p-values, which are drawn uniformly from the support of their CDF
+  std::uniform_real_distribution<double> unif(0, 1);
+  std::vector<int> cdf_of(cfg.numTests);
+  std::vector<double> pv(cfg.numTests);
+  std::vector<int> last_test(numCDF, -1);
+  for(int j = 0; j < cfg.numTests; j++) {
+    int i = j < numCDF ? j : (int)(unif(rng) * numCDF) % numCDF;
+    cdf_of[j] = i;
+    if(last_test[i] >= 0 && unif(rng) < cfg.ties) pv[j] = pv[last_test[i]];
+    else pv[j] = cdfs[i][(size_t)(unif(rng) * cdfs[i].size()) % cdfs[i].size()];
+    last_test[i] = j;
+  }
+
+  // sort p-values and determine the (1-based) sorted indices of each CDF
+  std::vector<int> ord(cfg.numTests);
+  for(int j = 0; j < cfg.numTests; j++) ord[j] = j;
+  std::stable_sort(ord.begin(), ord.end(), [&](int a, int b) { return pv[a] < pv[b]; });
+  bench_family fam;
+  fam.cdfs = cdfs;
+  fam.indices.resize(numCDF);
+  fam.sorted_pv.resize(cfg.numTests);
+  for(int j = 0; j < cfg.numTests; j++) {
+    fam.sorted_pv[j] = pv[ord[j]];
+    fam.indices[cdf_of[ord[j]]].push_back(j + 1);
+  }
+  return fam;
+}
+
+// computations of the kernels; each returns a checksum, so that the
+// computations cannot be optimized away
+static double run_singlestep_fast(const CDF_family &fam, const std::vector<double> &pv, const bool independence, const bool breakpoints, const int num_threads) {
+  int n = (int)pv.size();
+  std::vector<double> adjusted(n);
+  singlestep_adjust(fam, pv.data(), n, independence, breakpoints, num_threads, adjusted.data());
+  return adjusted[n - 1];
+}
+
+static double run_stepwise_fast(const CDF_family &fam, const std::vector<double> &pv, const bool independence, const bool breakpoints, const int num_threads) {
+  int n = (int)pv.size();
+  std::vector<double> adjusted(n);
+  stepwise_adjust(fam, pv.data(), n, independence, breakpoints, num_threads, adjusted.data());
+  return adjusted[0];
+}
+
+static double run_singlestep_crit(const CDF_family &fam, const std::vector<double> &pv, const double alpha, const bool independence, const int num_threads) {
+  std::vector<double> support = merge_support(fam);
+  int numActive = active_support(support.data(), (int)support.size(), std::max(alpha, pv.back()));
+  CDF_ranks ranks(truncate_family(fam, support[numActive - 1]), support.data(), numActive);
+  std::vector<double> support_transf(numActive), adjusted(pv.size());
+  singlestep_support_sums(ranks, fam, support.data(), numActive, independence, num_threads, support_transf.data());
+  double crit;
+  singlestep_critical(support.data(), (int)support.size(), support_transf.data(), numActive, &alpha, 1, pv.data(), (int)pv.size(), &crit, adjusted.data());
+  return crit;
+}
+
+static double run_stepwise_crit(const CDF_family &fam, const std::vector<double> &pv, const double alpha, const bool independence, critical_workspace &ws) {
+  std::vector<double> support = merge_support(fam);
+  int numValues = (int)support.size();
+  int numActive = active_support(support.data(), numValues, std::max(alpha, pv.back()));
+  ws.ranks.assign(truncate_family(fam, support[numActive - 1]), support.data(), numActive);
+  std::vector<double> crit(pv.size()), adjusted(pv.size());
+  stepwise_critical(ws.ranks, fam, support.data(), numValues, numActive, pv.data(), (int)pv.size(), &alpha, 1, independence, crit.data(), adjusted.data(), ws);
+  return crit[0];
+}
+
+struct bench_options {
+  std::string format;
+  int reps;
+  int num_threads;
+  unsigned seed;
+  bool quick;
+};
+
+// median runtime of 'reps' repetitions in seconds
+template<class F>
+static double time_median(const int reps, double &checksum, F fun) {
+  std::vector<double> times(reps);
+  for(int r = 0; r < reps; r++) {
+    auto t0 = std::chrono::steady_clock::now();
+    checksum += fun();
+    auto t1 = std::chrono::steady_clock::now();
+    times[r] = std::chrono::duration<double>(t1 - t0).count();
+  }
+  std::sort(times.begin(), times.end());
+  return times[reps / 2];
+}
+
+int main(int argc, char** argv) {
+  bench_options opt = {"csv", 5, 1, 42, false};
+  for(int k = 1; k < argc; k++) {
+    if(!std::strcmp(argv[k], "--format") && k + 1 < argc) opt.format = argv[++k];
+    else if(!std::strcmp(argv[k], "--reps") && k + 1 < argc) opt.reps = std::max(1, std::atoi(argv[++k]));
+    else if(!std::strcmp(argv[k], "--threads") && k + 1 < argc) opt.num_threads = std::max(1, std::atoi(argv[++k]));
+    else if(!std::strcmp(argv[k], "--seed") && k + 1 < argc) opt.seed = (unsigned)std::atoi(argv[++k]);
+    else if(!std::strcmp(argv[k], "--quick")) opt.quick = true;
+    else {
+      std::fprintf(stderr, "usage: %s [--format csv|json] [--reps N] [--threads T] [--seed S] [--quick]\n", argv[0]);
+      return 1;
+    }
+  }
+  bool json = opt.format == "json";
+
+  // scaling sweeps: number of tests, support length, duplication and ties,
+  // each varied separately around a base configuration
+  std::vector<bench_config> configs;
+  std::vector<int> tests = opt.quick ? std::vector<int>{100, 1000} : std::vector<int>{100, 1000, 10000, 50000};
+  std::vector<int> lengths = opt.quick ? std::vector<int>{10, 100} : std::vector<int>{10, 50, 200, 1000};
+  std::vector<double> dups = {0, 0.5, 0.9, 0.99};
+  std::vector<double> ties = {0, 0.5};
+  for(int t = 0; t < 3; t++) {
+    support_type type = (support_type)t;
+    for(int n : tests) configs.push_back({type, n, 50, 0.5, 0});
+    for(int len : lengths) configs.push_back({type, 1000, len, 0.5, 0});
+    for(double d : dups) configs.push_back({type, 1000, 50, d, 0});
+    for(double tie : ties) configs.push_back({type, 1000, 50, 0.9, tie});
+  }
+
+  const double alpha = 0.05;
+  critical_workspace ws;
+  std::mt19937 rng(opt.seed);
+  double checksum = 0;
+  bool first = true;
+  if(json) std::printf("[\n");
+  else std::printf("support,num_tests,num_cdfs,num_values,length,duplication,ties,kernel,independence,breakpoints,threads,reps,seconds\n");
+  for(const bench_config &cfg : configs) {
+    bench_family bf = generate(cfg, rng);
+    CDF_family fam = bf.view();
+    long numValues = 0;
+    for(int i = 0; i < fam.numCDF; i++) numValues += fam.lens[i];
+
+    for(int k = 0; k < 4; k++) for(int ind = 0; ind < 2; ind++) for(int bp = 0; bp < (k % 2 ? 1 : 2); bp++) {
+      // fast kernels are timed with and without breakpoints
+      bool crit = k % 2;
+      bool stepwise = k >= 2;
+      const char* name = stepwise ? (crit ? "stepwise_crit" : "stepwise_fast") : (crit ? "singlestep_crit" : "singlestep_fast");
+      double secs = time_median(opt.reps, checksum, [&]() {
+        if(!stepwise && !crit) return run_singlestep_fast(fam, bf.sorted_pv, ind, bp, opt.num_threads);
+        if(!stepwise) return run_singlestep_crit(fam, bf.sorted_pv, alpha, ind, opt.num_threads);
+        if(!crit) return run_stepwise_fast(fam, bf.sorted_pv, ind, bp, opt.num_threads);
+        return run_stepwise_crit(fam, bf.sorted_pv, alpha, ind, ws);
+      });
+      if(json) {
+        std::printf("%s  {\"support\": \"%s\", \"num_tests\": %d, \"num_cdfs\": %d, \"num_values\": %ld, \"length\": %d, \"duplication\": %g, \"ties\": %g, \"kernel\": \"%s\", \"independence\": %s, \"breakpoints\": %s, \"threads\": %d, \"reps\": %d, \"seconds\": %.9g}",
+                    first ? "" : ",\n", type_names[cfg.type], cfg.numTests, fam.numCDF, numValues, cfg.length, cfg.duplication, cfg.ties,
+                    name, ind ? "true" : "false", bp ? "true" : "false", opt.num_threads, opt.reps, secs);
+      } else {
+        std::printf("%s,%d,%d,%ld,%d,%g,%g,%s,%s,%s,%d,%d,%.9g\n",
+                    type_names[cfg.type], cfg.numTests, fam.numCDF, numValues, cfg.length, cfg.duplication, cfg.ties,
+                    name, ind ? "TRUE" : "FALSE", bp ? "TRUE" : "FALSE", opt.num_threads, opt.reps, secs);
+      }
+      first = false;
+    }
+  }
+  if(json) std::printf("\n]\n");
+  // checksum prevents the computations from being optimized away
+  std::fprintf(stderr, "checksum: %.17g\n", checksum);
+
+  return 0;
+}
@@ -0,0 +1,263 @@
+// standalone test driver for the R-independent core of the kernels
+// (inst/include/DiscreteFWER); it generates random families of discrete
+// p-value CDFs and checks the procedures (with all specializations of their
+// loops) against direct evaluations of their definitions, i.e. without the R
+// package (the C-callable API is checked against the R kernels by the package
+// tests)
+//
+// build (from the package root):
+//   g++ -O2 -std=c++11 -fopenmp -Iinst/include bench/test_core.cpp -o test_core
+//
+// usage:
+//   test_core [--families N] [--seed S]
+//
+// the number of failed checks is written to stdout; the exit status is 1 if
+// any check failed
+
+#include <DiscreteFWER/procedures.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace DiscreteFWER;
+
+// random family with sorted p-values and their CDF indices
+struct test_family {
+  std::vector<std::vector<double> > cdfs;
+  std::vector<std::vector<int> > indices;
+  std::vector<double> sorted_pv;
+
+  // R-independent view of the family
+  CDF_family view() const {
+    CDF_family fam((int)cdfs.size());
+    for(int i = 0; i < fam.numCDF; i++) {
+      fam.vals[i] = cdfs[i].data();
+      fam.lens[i] = CDF_length(cdfs[i].data(), (int)cdfs[i].size());
+      fam.counts[i] = (int)indices[i].size();
+      fam.indices[i] = indices[i].data();
+    }
+    return fam;
+  }
+};
+
+// random family; the CDF values lie on a cubic grid, so that CDFs share many
+// values and p-values are often tied
+static test_family generate_family(std::mt19937 &rng, const bool unit) {
+  std::uniform_int_distribution<int> dn(1, 40), dl(1, 25), dc(1, unit ? 1 : 4), dg(1, 199);
+  int numCDF = dn(rng);
+  test_family f;
+  f.cdfs.resize(numCDF);
+  f.indices.resize(numCDF);
+  std::vector<std::pair<double, int> > tests;
+  for(int i = 0; i < numCDF; i++) {
+    std::vector<double> &v = f.cdfs[i];
+    int len = dl(rng);
+    for(int k = 0; k < len - 1; k++) v.push_back(std::pow(dg(rng) / 200.0, 3));
+    v.push_back(1.0);
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+    // observed p-values (skewed towards small ones)
+    int count = dc(rng);
+    std::uniform_int_distribution<int> dk(0, (int)v.size() - 1);
+    for(int c = 0; c < count; c++) tests.push_back(std::make_pair(v[std::min(dk(rng), dk(rng))], i));
+  }
+  std::shuffle(tests.begin(), tests.end(), rng);
+  std::stable_sort(tests.begin(), tests.end(), [](const std::pair<double, int> &a, const std::pair<double, int> &b) {
+    return a.first < b.first;
+  });
+  for(size_t j = 0; j < tests.size(); j++) {
+    f.sorted_pv.push_back(tests[j].first);
+    f.indices[tests[j].second].push_back((int)j + 1);
+  }
+  return f;
+}
+
+// CDF of a p-value, i.e. the largest of its values that does not exceed 'x'
+static double eval_cdf(const std::vector<double> &cdf, const double x) {
+  double value = 0;
+  for(size_t k = 0; k < cdf.size() && cdf[k] <= x; k++) value = cdf[k];
+  return value;
+}
+
+// sum of the CDFs of the sorted p-values from the (0-based) 'first' one
+// onwards at 'x'
+static double stepwise_sum(const test_family &f, const int first, const double x) {
+  double sum = 0;
+  for(size_t i = 0; i < f.cdfs.size(); i++) {
+    int count = 0;
+    for(size_t k = 0; k < f.indices[i].size(); k++) if(f.indices[i][k] > first) count++;
+    if(count) sum += count * eval_cdf(f.cdfs[i], x);
+  }
+  return sum;
+}
+
+// adjusted sorted p-values by their definitions
+static std::vector<double> direct_adjusted(const test_family &f, const bool independence, const bool single_step) {
+  int numTests = (int)f.sorted_pv.size();
+  std::vector<double> adjusted(numTests, 0.0);
+  for(int j = 0; j < numTests; j++) {
+    if(single_step) {
+      for(size_t i = 0; i < f.cdfs.size(); i++) {
+        double value = eval_cdf(f.cdfs[i], f.sorted_pv[j]);
+        int count = (int)f.indices[i].size();
+        adjusted[j] += independence ? count * std::log(1 - value) : count * value;
+      }
+      if(independence) adjusted[j] = -std::expm1(adjusted[j]);
+      adjusted[j] = std::min(1.0, adjusted[j]);
+    } else adjusted[j] = stepwise_sum(f, j, f.sorted_pv[j]);
+  }
+  if(!single_step) stepwise_transform(numTests, independence, adjusted.data());
+  return adjusted;
+}
+
+// number of failed checks
+static int failures = 0;
+
+static void check(const bool ok, const char* what, const int family) {
+  if(ok) return;
+  if(failures < 20) std::printf("failed: %s (family %i)\n", what, family);
+  failures++;
+}
+
+static bool same_values(const std::vector<double> &a, const std::vector<double> &b) {
+  if(a.size() != b.size()) return false;
+  for(size_t k = 0; k < a.size(); k++)
+    if(!(std::fabs(a[k] - b[k]) <= 1e-12 * std::max(1.0, std::fabs(b[k])))) return false;
+  return true;
+}
+
+// numbers of rejections of a step-down procedure by comparing the sorted
+// p-values with their critical values or the adjusted ones with the level
+static int rejections_crit(const std::vector<double> &pv, const double* crit) {
+  int n = (int)pv.size();
+  for(int j = 0; j < n; j++) if(pv[j] > crit[j]) return j;
+  return n;
+}
+
+static int rejections_adjusted(const std::vector<double> &adjusted, const double alpha) {
+  int n = (int)adjusted.size();
+  for(int j = 0; j < n; j++) if(adjusted[j] > alpha) return j;
+  return n;
+}
+
+int main(int argc, char** argv) {
+  int numFamilies = 300;
+  unsigned seed = 42;
+  for(int a = 1; a < argc; a++) {
+    if(!std::strcmp(argv[a], "--families") && a + 1 < argc) numFamilies = std::atoi(argv[++a]);
+    else if(!std::strcmp(argv[a], "--seed") && a + 1 < argc) seed = (unsigned)std::atoi(argv[++a]);
+  }
+
+  std::mt19937 rng(seed);
+  const double alpha[] = {0.01, 0.05, 0.2};
+  const int numAlpha = 3;
+  critical_workspace crit_ws;
+  adjust_workspace adjust_ws;
+
+  for(int f = 0; f < numFamilies; f++) {
+    test_family family = generate_family(rng, f % 2 == 0);
+    CDF_family fam = family.view();
+    int numTests = (int)family.sorted_pv.size();
+    const double* pv = family.sorted_pv.data();
+    std::vector<double> support = merge_support(fam);
+    std::vector<double> out(numTests);
+
+    for(int ind = 0; ind < 2; ind++) {
+      bool independence = ind == 1;
+
+      // adjusted p-values by scanning and at the breakpoints of the CDFs,
+      // with one or several threads
+      std::vector<double> ss_ref = direct_adjusted(family, independence, true);
+      std::vector<double> sw_ref = direct_adjusted(family, independence, false);
+      for(int bp = 0; bp < 2; bp++) for(int threads = 1; threads <= 4; threads += 3) {
+        singlestep_adjust(fam, pv, numTests, independence, bp == 1, threads, out.data());
+        check(same_values(out, ss_ref), "single-step adjusted p-values", f);
+        stepwise_adjust(fam, pv, numTests, independence, bp == 1, threads, out.data());
+        check(same_values(out, sw_ref), "stepwise adjusted p-values", f);
+      }
+
+      // specializations for unit counts must be bit-identical to the generic
+      // instantiation on any range of p-values
+      if(unit_counts(fam)) for(int bp = 0; bp < 2; bp++) {
+        std::uniform_int_distribution<int> dr(0, numTests);
+        int a = dr(rng), b = dr(rng);
+        if(a > b) std::swap(a, b);
+        std::vector<double> unit(numTests, 0.0), generic(numTests, 0.0);
+        singlestep_sums(fam, 0, fam.numCDF, pv, a, b, independence, true, bp == 1, unit.data());
+        singlestep_sums(fam, 0, fam.numCDF, pv, a, b, independence, false, bp == 1, generic.data());
+        check(unit == generic, "single-step sums for unit counts", f);
+        std::fill(unit.begin(), unit.end(), 0.0);
+        std::fill(generic.begin(), generic.end(), 0.0);
+        stepwise_sums(fam, 0, fam.numCDF, pv, a, b, true, bp == 1, unit.data());
+        stepwise_sums(fam, 0, fam.numCDF, pv, a, b, false, bp == 1, generic.data());
+        check(unit == generic, "stepwise sums for unit counts", f);
+      }
+
+      // complete analysis of the p-values in reverse (unsorted) order
+      std::vector<double> reversed(family.sorted_pv.rbegin(), family.sorted_pv.rend());
+      std::vector<std::vector<int> > reversed_idx(family.indices);
+      for(size_t i = 0; i < reversed_idx.size(); i++)
+        for(size_t k = 0; k < reversed_idx[i].size(); k++) reversed_idx[i][k] = numTests + 1 - reversed_idx[i][k];
+      CDF_family unsorted = fam;
+      for(int i = 0; i < fam.numCDF; i++) unsorted.indices[i] = reversed_idx[i].data();
+      for(int ss = 0; ss < 2; ss++) {
+        adjust_pvalues(unsorted, reversed.data(), numTests, independence, ss == 1, 2, out.data(), adjust_ws);
+        std::reverse(out.begin(), out.end());
+        check(same_values(out, ss ? ss_ref : sw_ref), "adjusted p-values of unsorted p-values", f);
+      }
+
+      // critical values of single-step procedures
+      double limit = std::max(alpha[numAlpha - 1], pv[numTests - 1]);
+      int numActive = active_support(support.data(), (int)support.size(), limit);
+      CDF_ranks ranks(truncate_family(fam, support[numActive - 1]), support.data(), numActive);
+      std::vector<double> transf(numActive), crit(numAlpha), ss_adjusted(numTests);
+      if(unit_counts(fam)) {
+        std::vector<double> unit(numActive, 0.0), generic(numActive, 0.0);
+        singlestep_rank_sums(ranks, fam, 0, fam.numCDF, support.data(), 0, numActive, independence, true, unit.data());
+        singlestep_rank_sums(ranks, fam, 0, fam.numCDF, support.data(), 0, numActive, independence, false, generic.data());
+        check(unit == generic, "single-step support sums for unit counts", f);
+      }
+      singlestep_support_sums(ranks, fam, support.data(), numActive, independence, 2, transf.data());
+      singlestep_critical(support.data(), (int)support.size(), transf.data(), numActive, alpha, numAlpha, pv, numTests, crit.data(), ss_adjusted.data());
+      check(same_values(ss_adjusted, ss_ref), "single-step adjusted p-values with critical values", f);
+      for(int k = 0; k < numAlpha; k++) {
+        // largest support value whose transformation does not exceed the
+        // level (or the smallest one)
+        double expected = support[0];
+        for(int v = 0; v < numActive && support[v] <= alpha[k]; v++) if(transf[v] <= alpha[k]) expected = support[v];
+        check(crit[k] == expected, "single-step critical values", f);
+      }
+
+      // critical values of stepwise procedures with a reused workspace; their
+      // adjusted p-values are the sums of the CDFs without the running
+      // maximum (minimum)
+      std::vector<double> sw_crit((size_t)numTests * numAlpha), sw_adjusted(numTests);
+      crit_ws.ranks.assign(truncate_family(fam, support[numActive - 1]), support.data(), numActive);
+      stepwise_critical(crit_ws.ranks, fam, support.data(), (int)support.size(), numActive, pv, numTests, alpha, numAlpha, independence, sw_crit.data(), sw_adjusted.data(), crit_ws);
+      stepwise_transform(numTests, independence, sw_adjusted.data());
+      check(same_values(sw_adjusted, sw_ref), "stepwise adjusted p-values with critical values", f);
+      // under dependence, they must reject the same p-values as the adjusted
+      // ones, unless no value is small enough at the first p-value that is
+      // not rejected, as the critical value is the smallest one then (like in
+      // the original kernels); under independence, tied p-values get the
+      // critical value of their whole block, but the adjusted p-value of its
+      // last one, so that the rejections may differ
+      for(int k = 0; k < numAlpha && !independence; k++) {
+        const double* crit_k = sw_crit.data() + (size_t)k * numTests;
+        int by_crit = rejections_crit(family.sorted_pv, crit_k);
+        int by_adjusted = rejections_adjusted(sw_ref, alpha[k]);
+        int first = by_adjusted;
+        while(first > 0 && pv[first - 1] == pv[by_adjusted]) first--;
+        check(
+          by_crit == by_adjusted ||
+            (by_crit > by_adjusted && stepwise_sum(family, first, crit_k[by_adjusted]) > alpha[k]),
+          "stepwise rejections by critical values", f
+        );
+      }
+    }
+  }
+
+  std::printf("%i families, %i failed checks\n", numFamilies, failures);
+  return failures ? 1 : 0;
+}
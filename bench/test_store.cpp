@@ -0,0 +1,110 @@
+// standalone test driver for the memory use of CDF stores (src/store.h); it
+// writes a store of many short CDFs and checks (by the resident pages of its
+// mapping, Linux only) that opening it and creating its family does not read
+// the values and that streaming through the CDFs in blocks, whose pages are
+// released afterwards, stays within a small budget
+//
+// build (from the package root):
+//   g++ -O2 -std=c++11 -Iinst/include -Isrc bench/test_store.cpp -o test_store
+//
+// usage:
+//   test_store [--file F]
+//
+// the number of failed checks is written to stdout; the exit status is 1 if
+// any check failed
+
+#include "store.h"
+#include <cstdlib>
+#include <fstream>
+
+using namespace DiscreteFWER;
+
+// number of CDFs, values per CDF and CDFs per streamed block (64 MiB of
+// values in blocks of 2 MiB, 4 MiB of offsets)
+const int numCDF = 1 << 19, numValues = 16, blockSize = 1 << 14;
+
+// resident size (in bytes) of the mapping of 'file'
+static double resident(const std::string &file) {
+  std::ifstream smaps("/proc/self/smaps");
+  std::string line;
+  bool found = false;
+  double kb = 0;
+  while(std::getline(smaps, line)) {
+    if(line.find(file) != std::string::npos) found = true;
+    else if(found && line.compare(0, 4, "Rss:") == 0) {
+      kb += std::atof(line.c_str() + 4);
+      found = false;
+    }
+  }
+  return kb * 1024;
+}
+
+// writes the store without keeping its values in memory
+static void write_test_store(const std::string &file) {
+  store_header header;
+  std::memcpy(header.magic, "DFWERCDF", 8);
+  header.version = 1;
+  header.flags = 0;
+  header.numCDF = numCDF;
+  header.numValues = (uint64_t)numCDF * numValues;
+  header.numIndices = 0;
+  std::vector<uint64_t> offsets(numCDF + 1);
+  for(int i = 0; i <= numCDF; i++) offsets[i] = (uint64_t)i * numValues;
+  std::vector<double> vals(numValues);
+  for(int k = 0; k < numValues; k++) vals[k] = (k + 1.0) / numValues;
+
+  FILE* out = std::fopen(file.c_str(), "wb");
+  if(out == NULL) throw std::runtime_error("Cannot open file '" + file + "' for writing!");
+  std::fwrite(&header, sizeof(header), 1, out);
+  std::fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), out);
+  for(int i = 0; i < numCDF; i++) std::fwrite(vals.data(), sizeof(double), numValues, out);
+  if(std::fclose(out) != 0) throw std::runtime_error("Writing to file '" + file + "' failed!");
+}
+
+int main(int argc, char** argv) {
+  std::string file = "test_store.cdf";
+  for(int a = 1; a + 1 < argc; a += 2)
+    if(!std::strcmp(argv[a], "--file")) file = argv[a + 1];
+
+  int failed = 0;
+  write_test_store(file);
+  double offsets_size = (numCDF + 1.0) * sizeof(uint64_t), block_size = (double)blockSize * numValues * sizeof(double);
+  {
+    CDF_store store(file);
+    CDF_family fam = store.family();
+    // only the header and the offsets (plus the pages that are mapped
+    // around them) may be resident
+    double rss = resident(file);
+    if(rss > offsets_size + (1 << 20)) {
+      std::printf("family() reads the values: %.0f bytes resident\n", rss);
+      failed++;
+    }
+    for(int i = 0; i < numCDF; i++) if(fam.lens[i] != numValues) {
+      std::printf("wrong length of CDF %d\n", i + 1);
+      failed++;
+      break;
+    }
+
+    // stream through the CDFs like the kernels
+    double sum = 0, peak = 0;
+    for(int from = 0; from < numCDF; from += blockSize) {
+      int to = std::min(numCDF, from + blockSize);
+      for(int i = from; i < to; i++) for(int k = 0; k < fam.lens[i]; k++) sum += fam.vals[i][k];
+      store.release(from, to);
+      peak = std::max(peak, resident(file));
+    }
+    if(peak > offsets_size + 2 * block_size + (1 << 20)) {
+      std::printf("streaming exceeds the budget: %.0f bytes resident\n", peak);
+      failed++;
+    }
+    double expected = (double)numCDF * (numValues + 1) / 2;
+    if(std::abs(sum - expected) > 1e-6 * expected) {
+      std::printf("wrong sum of the values: %g instead of %g\n", sum, expected);
+      failed++;
+    }
+  }
+  std::remove(file.c_str());
+
+  std::printf("%d failed checks\n", failed);
+  return failed ? 1 : 0;
+}
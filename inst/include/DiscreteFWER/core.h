@@ -0,0 +1,762 @@
+#ifndef DISCRETEFWER_CORE_H
+#define DISCRETEFWER_CORE_H
+
+// R-independent building blocks of the kernels; nothing in here may use the R
+// API, as these functions may be executed by multiple threads; the header is
+// installed with the package, so that other packages and standalone programs
+// can use it (see also 'procedures.h')
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#endif
+
+// all names of the library are in the namespace 'DiscreteFWER', so that they
+// do not clash with those of programs that use it
+namespace DiscreteFWER {
+
+// computes the index of the largest element of a vector (or an array) which is
+// <= a given value
+template<class V>
+inline int binary_search(const V &vec, const double value, const int len) {
+  int idx_left = 0, idx_right = len - 1, idx_mid = len - 1;
+  bool stop = false;
+  
+  while(!stop) {
+    if(vec[idx_mid] > value) {
+      if(idx_mid == 0) {
+        stop = true;
+      } else if(idx_mid - idx_left == 1) {
+        stop = true;
+        idx_mid = idx_left;
+      } else {
+        idx_right = idx_mid;
+        idx_mid = idx_left + (idx_right - idx_left) / 2;
+      }
+    } else if(vec[idx_mid] <= value) {
+      if(vec[idx_mid] == value || idx_mid == len - 1 || idx_right - idx_mid == 1) {
+        stop = true;
+      } else {
+        idx_left = idx_mid;
+        idx_mid = idx_left + (idx_right - idx_left + 1) / 2;
+      }
+    }
+  }
+  
+  return idx_mid;
+}
+
+// number of values of a p-value CDF that can be attained, i.e. that are <= 1
+inline int CDF_length(const double* vals, int len) {
+  while(len > 0 && vals[len - 1] > 1) len--;
+  return len;
+}
+
+// comparison of a value with a CDF value that is rescaled by 'scale', for
+// searching in the (unscaled) values of a CDF
+struct scaled_less {
+  scaled_less(const double s) : scale(s) {}
+  inline bool operator()(const double x, const double v) const { return x < v / scale; }
+  double scale;
+};
+
+// index of the highest set bit of a non-zero word
+inline int highest_bit(const uint64_t word) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long idx;
+  _BitScanReverse64(&idx, word);
+  return (int)idx;
+#elif defined(__GNUC__)
+  return 63 - __builtin_clzll(word);
+#else
+  int idx = 0;
+  for(uint64_t w = word; w >>= 1;) idx++;
+  return idx;
+#endif
+}
+
+// incremental search structure for the critical values of stepwise
+// procedures: finds the largest index i > 0 of a point that belongs to the
+// running (combined) support and whose CDF sum does not exceed the threshold;
+// as the sums only grow, the largest index with sum <= threshold can only
+// decrease, so it is tracked by a monotone pointer, while supported indices
+// are stored in a two-level bitset for fast predecessor queries
+class crit_search {
+public:
+  crit_search() : limit(-1) {}
+  crit_search(const int len) { reset(len); }
+
+  // empties the running support for 'len' points (the bitsets keep their
+  // memory, if they are large enough)
+  inline void reset(const int len) {
+    limit = len - 1;
+    bits.assign((len + 63) / 64, 0);
+    summary.assign((bits.size() + 63) / 64, 0);
+  }
+
+  // adds index 'i' to the running support
+  inline void add_support(const int i) {
+    bits[i >> 6] |= 1ULL << (i & 63);
+    summary[i >> 12] |= 1ULL << ((i >> 6) & 63);
+  }
+
+  // bytes of the bitsets
+  inline double bytes() const {
+    return (double)(bits.capacity() + summary.capacity()) * sizeof(uint64_t);
+  }
+
+  // returns the index of the current critical value
+  inline int find(const double* sums, const double threshold) {
+    while(limit > 0 && sums[limit] > threshold) limit--;
+    int idx = pred(limit);
+    return idx > 0 ? idx : 0;
+  }
+
+private:
+  // largest index of a supported point <= 'i' (or -1, if there is none)
+  inline int pred(const int i) const {
+    if(i < 0) return -1;
+    int w = i >> 6;
+    uint64_t word = bits[w] & (~0ULL >> (63 - (i & 63)));
+    if(word) return (w << 6) + highest_bit(word);
+    // find previous non-empty word
+    if(w-- == 0) return -1;
+    int s = w >> 6;
+    uint64_t sword = summary[s] & (~0ULL >> (63 - (w & 63)));
+    while(!sword && s > 0) sword = summary[--s];
+    if(!sword) return -1;
+    w = (s << 6) + highest_bit(sword);
+    return (w << 6) + highest_bit(bits[w]);
+  }
+
+  int limit;
+  std::vector<uint64_t> bits;
+  std::vector<uint64_t> summary;
+};
+
+// plain view of a family of unique p-value CDFs
+struct CDF_family {
+  CDF_family(const int n) : numCDF(n), vals(n), lens(n), scales(n, 1.0), counts(n), indices(n) {}
+
+  // the k-th (rescaled) value of the i-th CDF
+  inline double value(const int i, const int k) const { return vals[i][k] / scales[i]; }
+
+  // number of unique CDFs
+  int numCDF;
+  // values of the CDFs and their lengths (only values that are <= 1 after
+  // rescaling)
+  std::vector<const double*> vals;
+  std::vector<int> lens;
+  // scale factors of the CDFs, i.e. the i-th CDF is 'vals[i] / scales[i]';
+  // selection of p-values rescales the CDFs without copying them
+  std::vector<double> scales;
+  // number of p-values to which each CDF belongs
+  std::vector<int> counts;
+  // sorted (1-based) indices of the sorted p-values to which each CDF belongs
+  // (only needed by stepwise procedures)
+  std::vector<const int*> indices;
+};
+
+// view of a family whose CDFs are truncated to their values <= 'limit'; CDF
+// evaluations at points <= 'limit' remain the same, but CDFs whose mass lies
+// mostly above it (e.g. near 1) are much shorter
+inline CDF_family truncate_family(const CDF_family &fam, const double limit) {
+  CDF_family trunc = fam;
+  for(int i = 0; i < fam.numCDF; i++)
+    trunc.lens[i] = std::upper_bound(fam.vals[i], fam.vals[i] + fam.lens[i], limit, scaled_less(fam.scales[i])) - fam.vals[i];
+  return trunc;
+}
+
+// rescales the CDFs of a family by the given factors, i.e. the i-th CDF
+// becomes 'vals[i] / scales[i]' and is truncated to its values <= 1 (a CDF
+// with factor 0 becomes empty)
+inline void scale_family(CDF_family &fam, const double* scales) {
+  for(int i = 0; i < fam.numCDF; i++) {
+    fam.scales[i] = scales[i];
+    fam.lens[i] = scales[i] > 0 ?
+      std::upper_bound(fam.vals[i], fam.vals[i] + fam.lens[i], 1.0, scaled_less(scales[i])) - fam.vals[i] : 0;
+  }
+}
+
+// number of support values that are needed to evaluate CDFs at points up to
+// 'limit', i.e. all values <= 'limit' and the next larger one (if any)
+inline int active_support(const double* support, const int numValues, const double limit) {
+  return std::min<int>(numValues, std::upper_bound(support, support + numValues, limit) - support + 1);
+}
+
+// sorted overall support of a family, i.e. all unique CDF values; as each CDF
+// is sorted, it is built by a k-way merge of the CDFs in O(N log k) instead of
+// sorting all N values
+inline std::vector<double> merge_support(const CDF_family &fam) {
+  // heap of the next value of each CDF along with its CDF and position
+  typedef std::pair<double, std::pair<int, int> > head;
+  std::priority_queue<head, std::vector<head>, std::greater<head> > heap;
+  size_t total = 0;
+  for(int i = 0; i < fam.numCDF; i++) {
+    total += fam.lens[i];
+    if(fam.lens[i] > 0) heap.push(head(fam.value(i, 0), std::make_pair(i, 0)));
+  }
+  
+  std::vector<double> support;
+  support.reserve(total);
+  while(!heap.empty()) {
+    head h = heap.top();
+    heap.pop();
+    if(support.empty() || support.back() != h.first) support.push_back(h.first);
+    int i = h.second.first, k = h.second.second + 1;
+    if(k < fam.lens[i]) heap.push(head(fam.value(i, k), std::make_pair(i, k)));
+  }
+  
+  return support;
+}
+
+// merges the sorted arrays 'x[0]', ..., 'x[lenX - 1]' and 'y[0]', ...,
+// 'y[lenY - 1]' into 'out' (which must have room for both) in linear time and
+// drops duplicates; returns the number of unique values
+inline int merge_unique(const double* x, const int lenX, const double* y, const int lenY, double* out) {
+  int i = 0, j = 0, n = 0;
+  while(i < lenX || j < lenY) {
+    double v = j == lenY || (i < lenX && x[i] <= y[j]) ? x[i++] : y[j++];
+    if(!n || out[n - 1] != v) out[n++] = v;
+  }
+  return n;
+}
+
+// rank-encoded (compact) representation of a family of p-value CDFs: each CDF
+// value is replaced by its (0-based) rank in the sorted overall support, which
+// must contain all of them; the CDFs are stored back to back in a single array
+// with the start of the i-th one at 'offsets[i]' (CSR layout)
+struct CDF_ranks {
+  CDF_ranks() {}
+  CDF_ranks(const CDF_family &fam, const double* support, const int numValues) {
+    assign(fam, support, numValues);
+  }
+
+  // encodes the CDFs of 'fam' (the arrays keep their memory, if they are
+  // large enough)
+  inline void assign(const CDF_family &fam, const double* support, const int numValues) {
+    offsets.assign(fam.numCDF + 1, 0);
+    for(int i = 0; i < fam.numCDF; i++) offsets[i + 1] = offsets[i] + fam.lens[i];
+    ranks.resize(offsets[fam.numCDF]);
+    for(int i = 0; i < fam.numCDF; i++) {
+      // both the CDF and the support are sorted, so the search range shrinks
+      int pos = 0;
+      for(int k = 0; k < fam.lens[i]; k++) {
+        pos = std::lower_bound(support + pos, support + numValues, fam.value(i, k)) - support;
+        ranks[offsets[i] + k] = pos;
+      }
+    }
+  }
+
+  // start of each CDF in 'ranks' (and total length at the end)
+  std::vector<int> offsets;
+  // ranks of the CDF values in the support
+  std::vector<int> ranks;
+
+  // calls 'fun(r, s, e)' for each value of the i-th CDF with support rank 'r'
+  // that is attained by the evaluation points 's', ..., 'e - 1' within 'a',
+  // ..., 'b - 1'; 'start[r]' is the index of the first evaluation point that is
+  // not smaller than the r-th support value (if 'start' is NULL, the support
+  // itself is evaluated, i.e. 'start[r] = r'); evaluation points before the
+  // first run are zero
+  template<class F>
+  inline void runs(const int i, const int* start, const int a, const int b, F fun) const {
+    const int* r = ranks.data() + offsets[i];
+    int len = offsets[i + 1] - offsets[i];
+    if(a >= b || !len) return;
+    auto pos = [start](int rank) { return start ? start[rank] : rank; };
+
+    // last value whose run begins not after 'a' (or first value, if none)
+    int k = std::upper_bound(r, r + len, a, [&](int x, int rank) { return x < pos(rank); }) - r;
+    if(k) k--;
+    for(; k < len; k++) {
+      int s = std::max<int>(pos(r[k]), a);
+      if(s >= b) break;
+      int e = k + 1 < len ? std::min<int>(pos(r[k + 1]), b) : b;
+      if(s < e) fun(r[k], s, e);
+    }
+  }
+};
+
+// whether each CDF of a family belongs to exactly one p-value; then the
+// kernels use specializations that do not multiply by the counts
+inline bool unit_counts(const CDF_family &fam) {
+  for(int i = 0; i < fam.numCDF; i++) if(fam.counts[i] != 1) return false;
+  return true;
+}
+
+// value 'f' of a CDF that is added to the sums of single-step procedures,
+// i.e. 'count * f' or, under independence, 'count * log(1 - f)'; resolved at
+// compile time, so that the loops of the kernels contain no branches
+template<bool Independence, bool UnitCounts>
+inline double transformed_value(const double f, const double count) {
+  double val = Independence ? std::log1p(-f) : f;
+  return UnitCounts ? val : count * val;
+}
+
+// adds the CDFs 'from', ..., 'to - 1', each multiplied by its count, evaluated
+// at 'pvalues[a]', ..., 'pvalues[b - 1]' to 'sums'; under independence,
+// log(1 - F) is summed instead; if 'breakpoints' is true, only the changes of
+// the sums at the CDFs' breakpoints are added, i.e. 'sums' is a difference
+// array that must be cumulated afterwards; specialized for the dependence
+// mode and for families whose counts are all 1 (see 'singlestep_sums')
+template<bool Independence, bool UnitCounts>
+inline void singlestep_sums_impl(
+  const CDF_family &fam,
+  const int from,
+  const int to,
+  const double* pvalues,
+  const int a,
+  const int b,
+  const bool breakpoints,
+  double* sums
+) {
+  if(a >= b) return;
+  
+  for(int i = from; i < to; i++) {
+    const double* vals = fam.vals[i];
+    int len = fam.lens[i];
+    double count = (double)fam.counts[i];
+    // (rescaled) k-th value of the CDF
+    const double scale = fam.scales[i];
+    auto value = [vals, scale](int k) { return vals[k] / scale; };
+    
+    if(breakpoints) {
+      // first breakpoint whose position in p-values is not smaller than 'a'
+      int k = a ? std::upper_bound(vals, vals + len, pvalues[a - 1], scaled_less(scale)) - vals : 0;
+      // last value that was added to the sums
+      double last = 0;
+      if(k) last = transformed_value<Independence, UnitCounts>(value(k - 1), count);
+      // position of current breakpoint in sorted p-values
+      int pos = a;
+      for(; k < len; k++) {
+        pos = std::lower_bound(pvalues + pos, pvalues + b, value(k)) - pvalues;
+        if(pos == b) break;
+        
+        double val = transformed_value<Independence, UnitCounts>(value(k), count);
+        sums[pos] += val - last;
+        last = val;
+      }
+    } else {
+      // the CDF is constant between its breakpoints, so each of its (log-)
+      // values is computed only once and added to the contiguous run of
+      // p-values it applies to; p-values with F = 0 (and log(1 - F) = 0) are
+      // skipped entirely
+      // number of CDF values <= first p-value, i.e. F(p_j) = value(k - 1)
+      int k = std::upper_bound(vals, vals + len, pvalues[a], scaled_less(scale)) - vals;
+      int j = a;
+      if(!k) {
+        if(!len) continue;
+        j = std::lower_bound(pvalues + a, pvalues + b, value(0)) - pvalues;
+        k = 1;
+      }
+      while(j < b) {
+        // end of the run of p-values for which F(p_j) = value(k - 1)
+        int end = k < len ? std::lower_bound(pvalues + j, pvalues + b, value(k)) - pvalues : b;
+        double val = transformed_value<Independence, UnitCounts>(value(k - 1), count);
+        for(; j < end; j++) sums[j] += val;
+        k++;
+      }
+    }
+  }
+}
+
+// selects the specialization of 'singlestep_sums_impl' for the dependence
+// mode and the layout of the counts ('unit_counts', see above) once per call
+inline void singlestep_sums(
+  const CDF_family &fam,
+  const int from,
+  const int to,
+  const double* pvalues,
+  const int a,
+  const int b,
+  const bool independence,
+  const bool unit_counts,
+  const bool breakpoints,
+  double* sums
+) {
+  if(independence) {
+    if(unit_counts) singlestep_sums_impl<true, true>(fam, from, to, pvalues, a, b, breakpoints, sums);
+    else singlestep_sums_impl<true, false>(fam, from, to, pvalues, a, b, breakpoints, sums);
+  } else {
+    if(unit_counts) singlestep_sums_impl<false, true>(fam, from, to, pvalues, a, b, breakpoints, sums);
+    else singlestep_sums_impl<false, false>(fam, from, to, pvalues, a, b, breakpoints, sums);
+  }
+}
+
+// family of p-value CDFs that is prepared once for repeated analyses of the
+// same tests: it owns copies of the CDF values, the sorted overall support and
+// the rank encoding of the CDFs; the transformed support of single-step
+// procedures is computed lazily and cached (along with the counts it belongs
+// to, as the selection of p-values may change them)
+struct prepared_family {
+  prepared_family(const CDF_family &fam) : view(fam.numCDF) {
+    std::vector<int> offsets(fam.numCDF + 1, 0);
+    for(int i = 0; i < fam.numCDF; i++) offsets[i + 1] = offsets[i] + fam.lens[i];
+    values.resize(offsets[fam.numCDF]);
+    for(int i = 0; i < fam.numCDF; i++) {
+      for(int k = 0; k < fam.lens[i]; k++) values[offsets[i] + k] = fam.value(i, k);
+      view.vals[i] = values.data() + offsets[i];
+      view.lens[i] = fam.lens[i];
+    }
+    // overall support, i.e. all unique CDF values
+    support = merge_support(view);
+    ranks = CDF_ranks(view, support.data(), (int)support.size());
+  }
+  
+  // cached transformed support for the given counts (or NULL, if there is none
+  // or if it does not cover the first 'len' support values)
+  inline const double* cached_transf(const bool independence, const std::vector<int> &counts, const int len) const {
+    if((int)support_transf[independence].size() < len || transf_counts[independence] != counts) return NULL;
+    return support_transf[independence].data();
+  }
+  
+  // stores the transformed first 'len' support values for the given counts
+  inline void cache_transf(const bool independence, const std::vector<int> &counts, const double* transf, const int len) {
+    support_transf[independence].assign(transf, transf + len);
+    transf_counts[independence] = counts;
+  }
+  
+  // values of all CDFs (only values <= 1) and a view of them
+  std::vector<double> values;
+  CDF_family view;
+  // sorted overall support and rank encoding of the CDFs
+  std::vector<double> support;
+  CDF_ranks ranks;
+  // transformed (first values of the) support without and with independence
+  // and their counts
+  std::vector<double> support_transf[2];
+  std::vector<int> transf_counts[2];
+};
+
+// like 'singlestep_sums', but the (rank-encoded) CDFs are evaluated at the
+// support values 'support[a]', ..., 'support[b - 1]' themselves; this
+// requires no comparisons of doubles, as the runs of the CDF values are given
+// by their ranks and the values are gathered from the support
+template<bool Independence, bool UnitCounts>
+inline void singlestep_rank_sums_impl(
+  const CDF_ranks &enc,
+  const CDF_family &fam,
+  const int from,
+  const int to,
+  const double* support,
+  const int a,
+  const int b,
+  double* sums
+) {
+  for(int i = from; i < to; i++) {
+    double count = (double)fam.counts[i];
+    enc.runs(i, NULL, a, b, [&](int r, int s, int e) {
+      double val = transformed_value<Independence, UnitCounts>(support[r], count);
+      for(int j = s; j < e; j++) sums[j] += val;
+    });
+  }
+}
+
+inline void singlestep_rank_sums(
+  const CDF_ranks &enc,
+  const CDF_family &fam,
+  const int from,
+  const int to,
+  const double* support,
+  const int a,
+  const int b,
+  const bool independence,
+  const bool unit_counts,
+  double* sums
+) {
+  if(independence) {
+    if(unit_counts) singlestep_rank_sums_impl<true, true>(enc, fam, from, to, support, a, b, sums);
+    else singlestep_rank_sums_impl<true, false>(enc, fam, from, to, support, a, b, sums);
+  } else {
+    if(unit_counts) singlestep_rank_sums_impl<false, true>(enc, fam, from, to, support, a, b, sums);
+    else singlestep_rank_sums_impl<false, false>(enc, fam, from, to, support, a, b, sums);
+  }
+}
+
+// adds the CDFs 'from', ..., 'to - 1', each multiplied by the number of its
+// p-values that are not smaller than the current one, evaluated at
+// 'sorted_pv[a]', ..., 'sorted_pv[b - 1]' to 'sums'; if 'breakpoints' is true,
+// only the changes of the sums are added, i.e. 'sums' is a difference array
+// that must be cumulated afterwards; specialized for families whose counts
+// are all 1 (see 'stepwise_sums')
+template<bool UnitCounts>
+inline void stepwise_sums_impl(
+  const CDF_family &fam,
+  const int from,
+  const int to,
+  const double* sorted_pv,
+  const int a,
+  const int b,
+  const bool breakpoints,
+  double* sums
+) {
+  for(int i = from; i < to; i++) {
+    const double* vals = fam.vals[i];
+    int len = fam.lens[i];
+    int count = fam.counts[i];
+    const int* indices = fam.indices[i];
+    // (rescaled) k-th value of the CDF
+    const double scale = fam.scales[i];
+    auto value = [vals, scale](int k) { return vals[k] / scale; };
+
+    if(breakpoints) {
+      // the product only changes at the CDF's breakpoints (i.e. the first
+      // p-values that are not smaller than its support values) and right after
+      // each of its p-values
+      // number of p-values of the i-th CDF before 'a'
+      int t = a ? std::upper_bound(indices, indices + count, a - 1) - indices : 0;
+      if(t == count) continue;
+      // current breakpoint and its position in sorted p-values
+      int k = a ? std::upper_bound(vals, vals + len, sorted_pv[a - 1], scaled_less(scale)) - vals : 0;
+      int pos_cdf = k < len ? std::lower_bound(sorted_pv + a, sorted_pv + b, value(k)) - sorted_pv : b;
+      // current CDF value and last value that was added to the sums
+      double f = k ? value(k - 1) : 0;
+      double last = f * (count - t);
+      while(t < count) {
+        int pos = std::min<int>(pos_cdf, indices[t]);
+        if(pos >= b) break;
+
+        while(pos_cdf == pos) {
+          f = value(k++);
+          pos_cdf = k < len ? std::lower_bound(sorted_pv + pos, sorted_pv + b, value(k)) - sorted_pv : b;
+        }
+        while(t < count && indices[t] == pos) t++;
+
+        double val = f * (count - t);
+        sums[pos] += val - last;
+        last = val;
+      }
+    } else {
+      // only p-values up to the last one of the i-th CDF are affected
+      int end = std::min<int>(b, indices[count - 1]);
+      if(a >= end) continue;
+
+      // the CDF only changes at its breakpoints and the multiplier right after
+      // each of its p-values, so constant values are added to the runs of
+      // p-values in between (there is only a single multiplier for unit
+      // counts)
+      // number of p-values of the i-th CDF before the current one
+      int t = UnitCounts ? 0 : std::upper_bound(indices, indices + count, a) - indices;
+      // number of CDF values <= current p-value, i.e. F(p_j) = value(k - 1)
+      int k = std::upper_bound(vals, vals + len, sorted_pv[a], scaled_less(scale)) - vals;
+      int j = a;
+      while(j < end) {
+        // end of the run of p-values with the same CDF value and multiplier
+        int run = k < len ? std::lower_bound(sorted_pv + j, sorted_pv + end, value(k)) - sorted_pv : end;
+        int stop = UnitCounts ? run : std::min<int>(run, indices[t]);
+        if(k) {
+          double val = UnitCounts ? value(k - 1) : value(k - 1) * (count - t);
+          for(int l = j; l < stop; l++) sums[l] += val;
+        }
+        j = stop;
+        if(!UnitCounts && j == indices[t]) t++;
+        if(j == run) k++;
+      }
+    }
+  }
+}
+
+// selects the specialization of 'stepwise_sums_impl' for the layout of the
+// counts ('unit_counts', see above) once per call
+inline void stepwise_sums(
+  const CDF_family &fam,
+  const int from,
+  const int to,
+  const double* sorted_pv,
+  const int a,
+  const int b,
+  const bool unit_counts,
+  const bool breakpoints,
+  double* sums
+) {
+  if(unit_counts) stepwise_sums_impl<true>(fam, from, to, sorted_pv, a, b, breakpoints, sums);
+  else stepwise_sums_impl<false>(fam, from, to, sorted_pv, a, b, breakpoints, sums);
+}
+
+// splits 'numValues' evaluation points into 'num_threads' contiguous ranges
+// and applies 'fun(a, b)' to each of them in parallel; since each range sums
+// the same CDFs in the same order, the results are bit-identical for any
+// number of threads and no reduction is necessary
+template<class F>
+inline void parallel_ranges(const int numValues, const int num_threads, F fun) {
+  if(num_threads <= 1 || numValues < 2) {
+    fun(0, numValues);
+    return;
+  }
+
+#ifdef _OPENMP
+  #pragma omp parallel for num_threads(num_threads) schedule(static)
+#endif
+  for(int t = 0; t < num_threads; t++)
+    fun((int)((int64_t)numValues * t / num_threads), (int)((int64_t)numValues * (t + 1) / num_threads));
+}
+
+// number of CDFs to be processed between two checks for user interrupts
+inline int CDF_block_size(const int numValues) {
+  return std::max<int>(1, (1 << 20) / std::max<int>(1, numValues));
+}
+
+// number of evaluation points per bin of the bounded approximation of the
+// sums (see 'approximate_adjust'), i.e. about the square root of their number,
+// so that the exact evaluations at the bin boundaries and within a few bins
+// cost about the same
+inline int approx_bin_size(const int numValues) {
+  return std::max<int>(2, (int)std::sqrt((double)numValues));
+}
+
+// statistics of a family and its p-values that determine the costs of the
+// evaluation strategies of the kernels; all of them are available after the
+// preprocessing in O(number of CDFs + number of tests)
+struct family_stats {
+  family_stats() : num_cdfs(0), num_values(0), num_tests(0), num_distinct(0),
+    scan_points(0), support_size(0), active_support(0) {}
+
+  int num_cdfs;
+  // total number of (attainable) values of the CDFs
+  double num_values;
+  int num_tests;
+  // number of distinct p-values, i.e. of blocks of tied ones
+  int num_distinct;
+  // total number of points at which a scan evaluates the CDFs (single-step:
+  // all p-values for each CDF; stepwise: the p-values up to its last one)
+  double scan_points;
+  // size of the overall support and number of its values after pruning (only
+  // needed for critical values)
+  int support_size;
+  int active_support;
+};
+
+// evaluation strategy of a kernel run (see 'choose_plan')
+struct kernel_plan {
+  kernel_plan() : breakpoints(false), pruned(true), approximate(false), rejections_only(false), num_threads(1), cost(0) {}
+
+  // adjusted p-values only: accumulate the CDFs at their breakpoints
+  // (range-add of their changes) instead of scanning the evaluation points
+  bool breakpoints;
+  // critical values only: truncate the CDFs and the support at the largest
+  // relevant value
+  bool pruned;
+  // bound the sums between the points of a coarse grid and evaluate them
+  // exactly only where the bounds do not determine the rejections (never
+  // chosen automatically)
+  bool approximate;
+  // adjusted p-values only: determine only the rejections and stop evaluating
+  // the CDFs as soon as they are known (never chosen automatically); then
+  // 'breakpoints' and 'cost' refer to the complete evaluation it falls back to
+  bool rejections_only;
+  int num_threads;
+  // estimated number of elementary operations of the chosen strategy
+  double cost;
+};
+
+// minimum estimated number of operations per thread for which a parallel
+// evaluation pays off (starting a team of threads costs some microseconds)
+const double min_work_per_thread = 65536;
+
+// chooses the cheapest evaluation strategy by a simple cost model, in which
+// evaluating a CDF at a point or a step of a binary search costs one
+// operation: a scan evaluates each CDF at each of its points and searches the
+// ends of its runs, while the breakpoint pass searches each breakpoint in the
+// p-values and cumulates the changes once; the kernels for critical values
+// evaluate each CDF at each (active) support value, and the stepwise search
+// processes each block of ties; only as many threads are used as get enough
+// work (the stepwise search for critical values is serial); an 'engine' other
+// than "auto" ("scan", "breakpoints", "pruned" or "full") enforces the
+// respective strategy with all 'num_threads' threads, e.g. for benchmarks;
+// "approx" (adjusted p-values and single-step critical values) evaluates the
+// CDFs at a grid of about the square root of the points and within a few bins;
+// "rejections" (adjusted p-values only) usually stops much earlier, but falls
+// back to the cheaper one of the scan and the breakpoint pass, so that its
+// cost is at most that of the latter (plus that of the abandoned scan)
+inline kernel_plan choose_plan(
+  const family_stats &st,
+  const bool crit_consts,
+  const bool single_step,
+  const int num_threads,
+  const std::string &engine = "auto"
+) {
+  kernel_plan plan;
+  bool automatic = engine == "auto";
+  double log_tests = std::log2(st.num_tests + 1.0);
+  int points = st.num_tests;
+  if(crit_consts) {
+    plan.pruned = engine != "full";
+    points = plan.pruned ? st.active_support : st.support_size;
+    plan.cost = (double)st.num_cdfs * points;
+    if(!single_step) plan.cost += st.num_distinct * std::log2(points + 1.0);
+  } else {
+    double cost_scan = st.scan_points + st.num_values * log_tests;
+    double cost_breakpoints = st.num_values * log_tests + st.num_tests;
+    if(!single_step) cost_breakpoints += (double)st.num_tests * log_tests;
+    plan.breakpoints = automatic || engine == "rejections" ? cost_breakpoints < cost_scan : engine == "breakpoints";
+    plan.cost = plan.breakpoints ? cost_breakpoints : cost_scan;
+  }
+  if(engine == "approx") {
+    plan.approximate = true;
+    plan.pruned = true;
+    plan.breakpoints = false;
+    double bin = approx_bin_size(points);
+    plan.cost = (double)st.num_cdfs * (points / bin + 2 * bin) + st.num_values * log_tests;
+  }
+  if(engine == "rejections") plan.rejections_only = true;
+  if(crit_consts && !single_step) {
+    plan.num_threads = 1;
+  } else if(automatic) {
+    double useful = std::floor(plan.cost / min_work_per_thread);
+    plan.num_threads = (int)std::max<double>(1, std::min<double>(useful, std::min(num_threads, points)));
+  } else plan.num_threads = num_threads;
+  
+  return plan;
+}
+
+// timings and counters of a kernel run, which are only recorded on request
+// (see 'discrete_fwer_native'); 'cdf_evaluations' counts the evaluations of
+// CDFs at single points (each breakpoint of an accumulation counts as one),
+// 'working_bytes' estimates the memory of the kernel's own buffers
+struct kernel_profile {
+  kernel_profile() : seconds_eval(0), seconds_search(0), cdf_evaluations(0),
+    support_size(0), active_support(0), tie_blocks(0), working_bytes(0) {}
+
+  // seconds spent evaluating the CDFs and searching for critical values
+  double seconds_eval;
+  double seconds_search;
+  double cdf_evaluations;
+  // size of the overall support and number of its values after pruning
+  int support_size;
+  int active_support;
+  // number of blocks of tied p-values processed by the stepwise search
+  int tie_blocks;
+  double working_bytes;
+};
+
+// wall clock for measuring the phases of a computation
+class phase_timer {
+public:
+  phase_timer() : start(std::chrono::steady_clock::now()) {}
+
+  // seconds since construction or the last call
+  inline double lap() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double secs = std::chrono::duration<double>(now - start).count();
+    start = now;
+    return secs;
+  }
+
+private:
+  std::chrono::steady_clock::time_point start;
+};
+
+} // namespace DiscreteFWER
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef DISCRETEFWER_INCREMENTAL_H
+#define DISCRETEFWER_INCREMENTAL_H
+
+// analyses of families that grow over time, e.g. in streaming screens whose
+// tests arrive in batches; each batch of new p-values and their CDFs is
+// absorbed without evaluating the CDFs of the earlier batches again
+//
+// the sorted new p-values are merged into the sorted earlier ones from the
+// back, so that only the earlier p-values after the smallest new one move;
+// single-step procedures keep the sums of all CDFs as a step function over
+// their support (see 'shard.h'), to which the shard of each batch is merged;
+// stepwise procedures keep the step function 'x -> sum of the CDFs at x of
+// the p-values > x' over the p-values and the CDF values below them, to
+// which a batch only adds its new CDFs on the support points below its
+// largest p-value; the sums at the sorted p-values are only read from it for
+// the results; merging the new points into the stored ones moves the later
+// points, i.e. it is linear in the size of the history, but involves no
+// sorting and no CDF evaluations; the results may differ in the last bits
+// from those of a complete analysis due to the different order of summation
+
+#include "shard.h"
+
+namespace DiscreteFWER {
+
+class incremental_family {
+public:
+  incremental_family(const bool independence, const bool single_step) :
+    independence(independence), single_step(single_step) {}
+
+  // whether the p-values are independent and whether a single-step procedure
+  // is performed
+  bool independence, single_step;
+
+  // number of p-values and of CDFs so far
+  inline int numTests() const { return (int)pvalues.size(); }
+  inline int numCDF() const { return (int)cdfs.size(); }
+
+  // absorbs the p-values 'new_pv[0]', ..., 'new_pv[numNew - 1]' and the CDFs
+  // of 'fam' (which are copied); 'fam.indices' and 'fam.counts' refer to the
+  // (1-based) positions in 'new_pv' (if 'fam.indices[i]' is NULL, the i-th CDF
+  // belongs to the i-th new p-value) and must contain each of them once
+  inline void append(const CDF_family &fam, const double* new_pv, const int numNew, const int num_threads) {
+    int numOld = numTests(), numOldCDF = numCDF(), numAll = numOld + numNew;
+    pvalues.insert(pvalues.end(), new_pv, new_pv + numNew);
+
+    // copies of the new CDFs and the (0-based, original) indices of their
+    // p-values
+    std::vector<std::vector<int> > new_tests(fam.numCDF);
+    for(int i = 0; i < fam.numCDF; i++) {
+      cdfs.push_back(std::vector<double>(fam.vals[i], fam.vals[i] + fam.lens[i]));
+      int count = fam.indices[i] ? fam.counts[i] : 1;
+      for(int k = 0; k < count; k++)
+        new_tests[i].push_back(numOld + (fam.indices[i] ? fam.indices[i][k] - 1 : i));
+    }
+
+    // sort order of the new p-values (ties keep their order), merged into the
+    // one of the earlier p-values from the back; the earlier p-values precede
+    // the new ones among ties and those before the smallest new p-value keep
+    // their positions
+    std::vector<int> new_order(numNew);
+    for(int j = 0; j < numNew; j++) new_order[j] = numOld + j;
+    std::stable_sort(new_order.begin(), new_order.end(), [&](int a, int b) {return pvalues[a] < pvalues[b];});
+    order.resize(numAll);
+    sorted_pv.resize(numAll);
+    for(int j = numOld - 1, k = numNew - 1, l = numAll - 1; k >= 0; l--) {
+      if(j >= 0 && sorted_pv[j] > pvalues[new_order[k]]) {
+        order[l] = order[j];
+        sorted_pv[l] = sorted_pv[j--];
+      } else {
+        order[l] = new_order[k];
+        sorted_pv[l] = pvalues[new_order[k--]];
+      }
+    }
+
+    if(single_step) {
+      // merge the shard of the new CDFs into the sums (only their counts are
+      // needed)
+      CDF_family added(fam.numCDF);
+      for(int i = 0; i < fam.numCDF; i++) {
+        added.vals[i] = cdfs[numOldCDF + i].data();
+        added.lens[i] = (int)cdfs[numOldCDF + i].size();
+        added.counts[i] = (int)new_tests[i].size();
+      }
+      singlestep_shard shard = make_shard(added, independence, 1.0, num_threads);
+      if(numOldCDF) {
+        std::vector<const singlestep_shard*> parts(2);
+        parts[0] = &sums;
+        parts[1] = &shard;
+        sums = merge_shards(parts);
+      } else sums = shard;
+    } else {
+      // sorted p-values of each new CDF, the value of its CDF at each of them
+      // and the support points of the new contributions, i.e. the p-values
+      // and the CDF values below the largest p-value of their CDF
+      std::vector<std::vector<double> > new_pv_sorted(fam.numCDF);
+      std::vector<double> points;
+      own.resize(numAll);
+      for(int i = 0; i < fam.numCDF; i++) {
+        const std::vector<double> &vals = cdfs[numOldCDF + i];
+        std::vector<double> &pv = new_pv_sorted[i];
+        for(size_t k = 0; k < new_tests[i].size(); k++) {
+          int t = new_tests[i][k];
+          size_t pos = std::upper_bound(vals.begin(), vals.end(), pvalues[t]) - vals.begin();
+          own[t] = pos ? vals[pos - 1] : 0.0;
+          pv.push_back(pvalues[t]);
+        }
+        if(pv.empty()) continue;
+        std::sort(pv.begin(), pv.end());
+        points.insert(points.end(), pv.begin(), pv.end());
+        points.insert(points.end(), vals.begin(), std::lower_bound(vals.begin(), vals.end(), pv.back()));
+      }
+      std::sort(points.begin(), points.end());
+      points.erase(std::unique(points.begin(), points.end()), points.end());
+
+      // merge the new points into the step function from the back; a new
+      // point takes over the sum of the point before it, as the sums are
+      // constant between the points
+      int numPoints = (int)step_points.size(), numInserted = 0;
+      for(size_t k = 0; k < points.size(); k++)
+        if(!std::binary_search(step_points.begin(), step_points.end(), points[k])) numInserted++;
+      step_points.resize(numPoints + numInserted);
+      step_sums.resize(numPoints + numInserted);
+      for(int j = numPoints - 1, k = (int)points.size() - 1, l = numPoints + numInserted - 1; k >= 0;) {
+        if(j >= 0 && step_points[j] > points[k]) {
+          step_points[l] = step_points[j];
+          step_sums[l--] = step_sums[j--];
+        } else if(j >= 0 && step_points[j] == points[k]) {
+          k--;
+        } else {
+          step_points[l] = points[k--];
+          step_sums[l--] = j >= 0 ? step_sums[j] : 0.0;
+        }
+      }
+
+      // add the new CDFs up to the largest new point: the contribution of
+      // each CDF increases at its values by the number of its p-values above
+      // them and drops at each of its p-values by the value before it; the
+      // changes are summed per range of CDFs and accumulated once
+      int end = points.empty() ? 0 : (int)(std::lower_bound(step_points.begin(), step_points.end(), points.back()) - step_points.begin()) + 1;
+      int numParts = std::max<int>(1, std::min<int>(num_threads, fam.numCDF));
+      std::vector<std::vector<double> > changes(numParts, std::vector<double>(end, 0.0));
+      auto index = [&](const double x) {
+        return std::lower_bound(step_points.begin(), step_points.begin() + end, x) - step_points.begin();
+      };
+      parallel_ranges(numParts, numParts, [&](int a, int b) {
+        for(int part = a; part < b; part++) {
+          std::vector<double> &change = changes[part];
+          int from = (int)((int64_t)fam.numCDF * part / numParts), to = (int)((int64_t)fam.numCDF * (part + 1) / numParts);
+          for(int i = from; i < to; i++) {
+            const std::vector<double> &vals = cdfs[numOldCDF + i], &pv = new_pv_sorted[i];
+            int count = (int)pv.size(), k = 0, len = (int)vals.size();
+            double before = 0.0;
+            for(int j = 0; j < count;) {
+              if(k < len && vals[k] < pv[j]) {
+                change[index(vals[k])] += (vals[k] - before) * (count - j);
+                before = vals[k++];
+              } else change[index(pv[j++])] -= before;
+            }
+          }
+        }
+      });
+      double change = 0.0;
+      for(int l = 0; l < end; l++) {
+        for(int part = 0; part < numParts; part++) change += changes[part][l];
+        step_sums[l] += change;
+      }
+    }
+  }
+
+  // adjusted sorted p-values, written to 'adjusted'
+  inline void adjusted_sorted(double* adjusted) const {
+    int n = numTests();
+    if(!n) return;
+    if(single_step) {
+      // value of the step function at each sorted p-value
+      const std::vector<double> &points = sums.points;
+      size_t pos = 0;
+      for(int j = 0; j < n; j++) {
+        while(pos < points.size() && points[pos] <= sorted_pv[j]) pos++;
+        adjusted[j] = pos ? sums.sums[pos - 1] : 0.0;
+      }
+      singlestep_transform(n, independence, adjusted);
+    } else {
+      // value of the step function at each sorted p-value plus the values of
+      // the CDFs of the tied p-values that are not before it
+      size_t pos = step_points.size();
+      double ties = 0.0;
+      for(int j = n - 1; j >= 0; j--) {
+        if(j == n - 1 || sorted_pv[j] != sorted_pv[j + 1]) ties = 0.0;
+        ties += own[order[j]];
+        while(pos && step_points[pos - 1] > sorted_pv[j]) pos--;
+        adjusted[j] = (pos ? step_sums[pos - 1] : 0.0) + ties;
+      }
+      stepwise_transform(n, independence, adjusted);
+    }
+  }
+
+  // critical values of single-step procedures for the FWER levels 'alpha[0]',
+  // ..., 'alpha[numAlpha - 1]', written to 'crit'
+  inline void critical(const double* alpha, const int numAlpha, double* crit) const {
+    std::vector<double> adjusted(numTests());
+    finalize_shard(sums, alpha, numAlpha, sorted_pv.data(), numTests(), crit, adjusted.data());
+  }
+
+  // p-values in their original order and sorted and the (0-based) original
+  // index of each sorted p-value
+  std::vector<double> pvalues, sorted_pv;
+  std::vector<int> order;
+
+private:
+  // copies of the CDFs
+  std::vector<std::vector<double> > cdfs;
+  // single-step procedures: sums of all CDFs over their support
+  singlestep_shard sums;
+  // stepwise procedures: value of the CDF of each p-value at it (in the
+  // original order) and the sums of the CDFs of the larger p-values at their
+  // support points and the p-values
+  std::vector<double> own, step_points, step_sums;
+};
+
+} // namespace DiscreteFWER
+
+#endif
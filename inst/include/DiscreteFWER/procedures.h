@@ -0,0 +1,963 @@
+#ifndef DISCRETEFWER_PROCEDURES_H
+#define DISCRETEFWER_PROCEDURES_H
+
+// R-independent implementations of the discrete FWER procedures on plain
+// arrays; the Rcpp kernels of the package, its C-callable API (see
+// 'DiscreteFWER_API.h') and standalone programs are thin wrappers around these
+// functions, which never allocate memory for their results (the caller passes
+// the output buffers and, for complete analyses, a reusable workspace)
+
+#include "core.h"
+#include <limits>
+
+namespace DiscreteFWER {
+
+// callback after each block of CDFs that does nothing (e.g. the R kernels
+// check for user interrupts there and release the pages of a CDF store)
+struct no_block_hook {
+  inline void operator()(const int, const int) const {}
+};
+
+// adjusted p-values of single-step procedures (d-Bonferroni, d-Sidak) at the
+// sorted p-values 'pvalues[0]', ..., 'pvalues[numValues - 1]', written to
+// 'adjusted'; the counts of the CDFs must be set
+template<class Hook = no_block_hook>
+inline void singlestep_adjust(
+  const CDF_family &fam,
+  const double* pvalues,
+  const int numValues,
+  const bool independence,
+  const bool breakpoints,
+  const int num_threads,
+  double* adjusted,
+  Hook after_block = Hook()
+) {
+  double* sums = adjusted;
+  std::fill(sums, sums + numValues, 0.0);
+  // specialization of the sums for the counts
+  bool unit = unit_counts(fam);
+  // add CDFs in blocks
+  int block = CDF_block_size(numValues);
+  for(int from = 0; from < fam.numCDF; from += block) {
+    int to = std::min<int>(fam.numCDF, from + block);
+    parallel_ranges(numValues, num_threads, [&](int a, int b) {
+      singlestep_sums(fam, from, to, pvalues, a, b, independence, unit, breakpoints, sums);
+    });
+    after_block(from, to);
+  }
+  // with breakpoints, the sums are the cumulative sums of their changes
+  if(breakpoints)
+    for(int j = 1; j < numValues; j++) sums[j] += sums[j - 1];
+
+  // revert logarithm, i.e. 1 - exp(sum)
+  if(independence)
+    for(int j = 0; j < numValues; j++) sums[j] = -std::expm1(sums[j]);
+
+  // compute adjustments
+  for(int j = 0; j < numValues; j++)
+    if(adjusted[j] > 1.0) adjusted[j] = 1.0;
+}
+
+// transformation of stepwise sums, i.e. their running minimum from the top
+// under independence (step-up) and their running maximum otherwise
+// (step-down), limited to 1
+inline void stepwise_transform(const int numTests, const bool independence, double* sums) {
+  if(numTests == 0) return;
+  sums[numTests - 1] = std::min<double>(1.0, sums[numTests - 1]);
+  if(independence)
+    for(int i = numTests - 2; i >= 0; i--)
+      sums[i] = std::min<double>(sums[i], sums[i + 1]);
+  else {
+    sums[0] = std::min<double>(1.0, sums[0]);
+    for(int i = 1; i < numTests; i++)
+      sums[i] = std::max<double>(sums[i - 1], std::min<double>(1.0, sums[i]));
+  }
+}
+
+// adjusted p-values of stepwise procedures (d-Holm, d-Hochberg) at the sorted
+// p-values 'sorted_pv[0]', ..., 'sorted_pv[numTests - 1]', written to
+// 'adjusted'; the counts and (sorted, 1-based) indices of the CDFs must be set
+template<class Hook = no_block_hook>
+inline void stepwise_adjust(
+  const CDF_family &fam,
+  const double* sorted_pv,
+  const int numTests,
+  const bool independence,
+  const bool breakpoints,
+  const int num_threads,
+  double* adjusted,
+  Hook after_block = Hook()
+) {
+  if(numTests == 0) return;
+
+  double* sums = adjusted;
+  std::fill(sums, sums + numTests, 0.0);
+  // specialization of the sums for the counts
+  bool unit = unit_counts(fam);
+  // add CDFs in blocks
+  int block = CDF_block_size(numTests);
+  for(int from = 0; from < fam.numCDF; from += block) {
+    int to = std::min<int>(fam.numCDF, from + block);
+    parallel_ranges(numTests, num_threads, [&](int a, int b) {
+      stepwise_sums(fam, from, to, sorted_pv, a, b, unit, breakpoints, sums);
+    });
+    after_block(from, to);
+  }
+  // with breakpoints, the sums are the cumulative sums of their changes
+  if(breakpoints)
+    for(int j = 1; j < numTests; j++) sums[j] += sums[j - 1];
+
+  // compute adjustments
+  stepwise_transform(numTests, independence, adjusted);
+}
+
+// untransformed sums of single-step procedures at the support values
+// 'support[0]', ..., 'support[numActive - 1]', i.e. the sums of the
+// (rank-encoded) CDFs or, under independence, of the logarithms of their
+// complements, written to 'sums'
+template<class Hook = no_block_hook>
+inline void singlestep_support_partial_sums(
+  const CDF_ranks &ranks,
+  const CDF_family &fam,
+  const double* support,
+  const int numActive,
+  const bool independence,
+  const int num_threads,
+  double* sums,
+  Hook after_block = Hook()
+) {
+  std::fill(sums, sums + numActive, 0.0);
+  // specialization of the sums for the counts
+  bool unit = unit_counts(fam);
+  // add CDFs in blocks
+  int block = CDF_block_size(numActive);
+  for(int from = 0; from < fam.numCDF; from += block) {
+    int to = std::min<int>(fam.numCDF, from + block);
+    parallel_ranges(numActive, num_threads, [&](int a, int b) {
+      singlestep_rank_sums(ranks, fam, from, to, support, a, b, independence, unit, sums);
+    });
+    after_block(from, to);
+  }
+}
+
+// transformation of untransformed single-step sums, i.e. 1 - exp(sum) under
+// independence, limited to 1
+inline void singlestep_transform(const int numValues, const bool independence, double* sums) {
+  for(int j = 0; j < numValues; j++) {
+    if(independence) sums[j] = -std::expm1(sums[j]);
+    sums[j] = std::min<double>(1.0, sums[j]);
+  }
+}
+
+// transformed support of single-step procedures, i.e. the sums of the
+// (rank-encoded) CDFs at the support values 'support[0]', ...,
+// 'support[numActive - 1]', written to 'sums'
+template<class Hook = no_block_hook>
+inline void singlestep_support_sums(
+  const CDF_ranks &ranks,
+  const CDF_family &fam,
+  const double* support,
+  const int numActive,
+  const bool independence,
+  const int num_threads,
+  double* sums,
+  Hook after_block = Hook()
+) {
+  singlestep_support_partial_sums(ranks, fam, support, numActive, independence, num_threads, sums, after_block);
+  singlestep_transform(numActive, independence, sums);
+}
+
+// critical values of single-step procedures for the FWER levels 'alpha[0]',
+// ..., 'alpha[numAlpha - 1]' (written to 'crit') and the adjusted sorted
+// p-values (written to 'adjusted'), given the transformed support
+// 'support_transf' of the active support values
+inline void singlestep_critical(
+  const double* support,
+  const int numValues,
+  const double* support_transf,
+  const int numActive,
+  const double* alpha,
+  const int numAlpha,
+  const double* sorted_pv,
+  const int numTests,
+  double* crit,
+  double* adjusted
+) {
+  for(int k = 0; k < numAlpha; k++) {
+    // restrict support to values <= alpha (critical value cannot exceed alpha)
+    int idx_max = binary_search(support, alpha[k], numValues);
+    // get index of critical value
+    crit[k] = support[binary_search(support_transf, alpha[k], idx_max + 1)];
+  }
+
+  // search for sorted p-values in the support and save their adjustments
+  int idx_pval = 0;
+  for(int i = 0; i < numTests; i++) {
+    while(idx_pval < numActive - 1 && support[idx_pval] < sorted_pv[i]) idx_pval++;
+    adjusted[i] = std::min<double>(1.0, support_transf[idx_pval]);
+  }
+}
+
+// reusable buffers of the kernels for critical values (see
+// 'stepwise_critical'); they keep their memory between searches, so that the
+// search itself allocates nothing and repeated searches only allocate, if a
+// family needs more than any before
+struct critical_workspace {
+  // rank encoding of the (truncated) CDFs, if the caller has none (e.g. of a
+  // prepared family)
+  CDF_ranks ranks;
+  // sums of the CDFs (first the [d-Bonf] sums at the support, then the sums
+  // at the combined support) and combined support of all FWER levels
+  std::vector<double> sums, points;
+  // positions of the support values in the combined support: index of the
+  // first point that is not smaller and index of the equal one (or -1)
+  std::vector<int> start, index;
+  // whether each point of the combined support is an observed p-value
+  std::vector<char> observed;
+  // CDF of each sorted p-value, CDFs of the current block of tied p-values
+  // and their counts in it (zero outside of the block)
+  std::vector<int> pv2CDF, block, counts;
+  // for each FWER level: range of the support that contains its [d-Bonf]
+  // critical value, index of the latter in the support and in the combined
+  // support and index of the smallest possible critical value
+  std::vector<int> lower, upper, first, first_idx, smallest_idx;
+  // search structures for the critical values of each FWER level
+  std::vector<crit_search> search;
+
+  // bytes of all buffers
+  inline double bytes() const {
+    double b = (double)(ranks.ranks.capacity() + ranks.offsets.capacity()) * sizeof(int) +
+      (double)(sums.capacity() + points.capacity()) * sizeof(double) +
+      (double)(start.capacity() + index.capacity() + pv2CDF.capacity() + block.capacity() + counts.capacity()) * sizeof(int) +
+      (double)(lower.capacity() + upper.capacity() + first.capacity() + first_idx.capacity() + smallest_idx.capacity()) * sizeof(int) +
+      (double)observed.capacity();
+    for(size_t a = 0; a < search.size(); a++) b += search[a].bytes();
+    return b;
+  }
+};
+
+// critical values of stepwise procedures (d-Holm, d-Hochberg) for the FWER
+// levels 'alpha[0]', ..., 'alpha[numAlpha - 1]' at each sorted p-value
+// (written column by column to the 'numTests' x 'numAlpha' array 'crit') and
+// the untransformed adjusted sorted p-values (written to 'adjusted'), given
+// the rank encoding of the CDFs in the support 'support[0]', ...,
+// 'support[numValues - 1]', of which the first 'numActive' values are needed;
+// the counts and (sorted, 1-based) indices of the CDFs must be set; the CDFs
+// are added in decreasing order of their p-values and the critical values
+// are found incrementally (see 'crit_search'); all buffers are taken from
+// 'ws', and 'profile' (if not NULL) receives the timings and counters
+template<class Hook = no_block_hook>
+inline void stepwise_critical(
+  const CDF_ranks &ranks,
+  const CDF_family &fam,
+  const double* support,
+  const int numValues,
+  const int numActive,
+  const double* sorted_pv,
+  const int numTests,
+  const double* alpha,
+  const int numAlpha,
+  const bool independence,
+  double* crit,
+  double* adjusted,
+  critical_workspace &ws,
+  kernel_profile* profile = NULL,
+  Hook after_block = Hook()
+) {
+  phase_timer timer;
+  int numCDF = fam.numCDF;
+
+  // CDF of each sorted p-value
+  ws.pv2CDF.resize(numTests);
+  for(int i = 0; i < numCDF; i++)
+    for(int k = 0; k < fam.counts[i]; k++) ws.pv2CDF[fam.indices[i][k] - 1] = i;
+
+  // finding critical values of [d-Bonf]; reduce support to the range of each
+  // FWER level first (smallest and largest index of each range)
+  ws.lower.resize(numAlpha);
+  ws.upper.resize(numAlpha);
+  for(int k = 0; k < numAlpha; k++) {
+    ws.lower[k] = binary_search(support, alpha[k] / numTests, numValues);
+    ws.upper[k] = ws.lower[k] + binary_search(support + ws.lower[k], alpha[k], numValues - ws.lower[k]);
+  }
+  // the CDFs are summed only once over the union of these ranges
+  int lower_all = *std::min_element(ws.lower.begin(), ws.lower.end());
+  int upper_all = *std::max_element(ws.upper.begin(), ws.upper.end());
+  ws.sums.assign(upper_all - lower_all + 1, 0.0);
+  double* sums = ws.sums.data() - lower_all;
+  for(int i = 0; i < numCDF; i++) {
+    ranks.runs(i, NULL, lower_all, upper_all + 1, [&](int r, int s, int e) {
+      double val = fam.counts[i] * support[r];
+      for(int j = s; j < e; j++) sums[j] += val;
+    });
+    after_block(i, i + 1);
+  }
+  // support index of critical value of [d-Bonf] of each FWER level
+  ws.first.resize(numAlpha);
+  for(int k = 0; k < numAlpha; k++)
+    ws.first[k] = ws.lower[k] + binary_search(sums + ws.lower[k], alpha[k], ws.upper[k] - ws.lower[k] + 1);
+  int first_all = *std::min_element(ws.first.begin(), ws.first.end());
+  if(profile) {
+    profile->seconds_eval += timer.lap();
+    profile->cdf_evaluations += (double)numCDF * (upper_all - lower_all + 1);
+  }
+
+  // combined support of all FWER levels, i.e. the support values from the
+  // smallest [d-Bonf] critical value on and the observed p-values (both are
+  // sorted, so they are merged in linear time)
+  ws.points.resize(upper_all - first_all + 1 + numTests);
+  int numPoints = merge_unique(support + first_all, upper_all - first_all + 1, sorted_pv, numTests, ws.points.data());
+  ws.points.resize(numPoints);
+  const double* points = ws.points.data();
+
+  // positions of the support values in the combined support; support values
+  // beyond the active ones are larger than all values of the combined support
+  ws.start.assign(numValues, numPoints);
+  ws.index.assign(numValues, -1);
+  for(int r = 0, j = 0; r < numActive; r++) {
+    while(j < numPoints && points[j] < support[r]) j++;
+    ws.start[r] = j;
+    if(j < numPoints && points[j] == support[r]) ws.index[r] = j;
+  }
+  // which values of the combined support are observed p-values
+  ws.observed.assign(numPoints, 0);
+  for(int i = 0, j = 0; i < numTests; i++) {
+    while(points[j] < sorted_pv[i]) j++;
+    ws.observed[j] = 1;
+  }
+  // the combined support of a single FWER level only contains the support
+  // values from its [d-Bonf] critical value on (and all observed p-values), so
+  // for each level, only these may become critical values; if none of them
+  // does, the smallest one is taken
+  int first_obs = std::lower_bound(points, points + numPoints, sorted_pv[0]) - points;
+  ws.first_idx.resize(numAlpha);
+  ws.smallest_idx.resize(numAlpha);
+  for(int k = 0; k < numAlpha; k++) {
+    ws.first_idx[k] = ws.index[ws.first[k]];
+    ws.smallest_idx[k] = std::min<int>(ws.first_idx[k], first_obs);
+  }
+
+  // critical values default to the [d-Bonf] ones
+  for(int k = 0; k < numAlpha; k++)
+    std::fill(crit + (size_t)k * numTests, crit + (size_t)(k + 1) * numTests, support[ws.first[k]]);
+  std::fill(adjusted, adjusted + numTests, 0.0);
+  // sums at the combined support
+  ws.sums.assign(numPoints, 0.0);
+  sums = ws.sums.data();
+  // search structures for critical values of each FWER level that also store
+  // which p-values are in the current combined support
+  ws.search.resize(numAlpha);
+  for(int a = 0; a < numAlpha; a++) ws.search[a].reset(numPoints);
+  // counts of the CDFs in the current block (all zero in between)
+  ws.counts.assign(numCDF, 0);
+  // adds the attainable values of a CDF to the combined supports
+  auto add_support = [&](int idx_CDF) {
+    for(int k = ranks.offsets[idx_CDF]; k < ranks.offsets[idx_CDF + 1]; k++) {
+      // the ranks of a CDF are sorted, so no further value is active
+      if(ranks.ranks[k] >= numActive) break;
+      int j = ws.index[ranks.ranks[k]];
+      if(j < 0) continue;
+      for(int a = 0; a < numAlpha; a++)
+        if(j >= ws.first_idx[a] || ws.observed[j]) ws.search[a].add_support(j);
+    }
+  };
+  // finds the index of the current critical value of the a-th FWER level
+  auto find_crit = [&](int a) {
+    return std::max<int>(ws.search[a].find(sums, alpha[a]), ws.smallest_idx[a]);
+  };
+  // index of current critical value to be computed
+  int idx_crit = numTests - 1;
+  // current position in the combined support for transforming observed
+  // p-values
+  int idx_transf = numPoints - 1;
+  // number of CDF evaluations and of p-value "blocks" (for profiling)
+  double evaluations = 0;
+  int num_blocks = 0;
+
+  // search for critical values and transform observed p-values
+  while(idx_crit >= 0) {
+    // number of observed p-values equal to current one ("block" size)
+    int count_pv = 1;
+    while(count_pv <= idx_crit && sorted_pv[idx_crit - count_pv] == sorted_pv[idx_crit])
+      count_pv++;
+
+    // find current p-value in the combined support for adjustment
+    while(idx_transf > 0 && points[idx_transf] > sorted_pv[idx_crit])
+      idx_transf--;
+
+    // determine critical value and transformation
+    if(count_pv == 1) {  // current p-value is unique
+      // index of CDF belonging to current p-value
+      int idx_CDF = ws.pv2CDF[idx_crit];
+
+      // add CDF's attainable values to support and its values to the sums
+      add_support(idx_CDF);
+      evaluations += numPoints;
+      ranks.runs(idx_CDF, ws.start.data(), 0, numPoints, [&](int r, int s, int e) {
+        for(int j = s; j < e; j++) sums[j] += support[r];
+      });
+
+      // find and save critical values
+      for(int a = 0; a < numAlpha; a++)
+        crit[idx_crit + (size_t)a * numTests] = points[find_crit(a)];
+
+      // untransformed adjusted p-value
+      if(points[idx_transf] == sorted_pv[idx_crit])
+        adjusted[idx_crit] = std::min<double>(1.0, sums[idx_transf]);
+
+      // go to next critical value
+      idx_crit--;
+    } else {  // current p-value is not unique (i.e. in a "block")
+      num_blocks++;
+      // counts of the CDFs of the current "block"; the CDFs are added in
+      // increasing order, like all of them were passed once
+      ws.block.clear();
+      for(int i = idx_crit - count_pv + 1; i <= idx_crit; i++) {
+        int idx_CDF = ws.pv2CDF[i];
+        if(!ws.counts[idx_CDF]++) ws.block.push_back(idx_CDF);
+      }
+      std::sort(ws.block.begin(), ws.block.end());
+      // CDF of the last p-value of the "block"
+      int idx_last = ws.pv2CDF[idx_crit];
+      // last sum of current p-value
+      double pval_sum_last = sums[idx_transf];
+
+      for(size_t b = 0; b < ws.block.size(); b++) {
+        int idx_CDF = ws.block[b];
+        // add CDF's attainable values to support and its values to the sums
+        add_support(idx_CDF);
+        evaluations += numPoints;
+        ranks.runs(idx_CDF, ws.start.data(), 0, numPoints, [&](int r, int s, int e) {
+          double val = support[r] * ws.counts[idx_CDF];
+          for(int j = s; j < e; j++) sums[j] += val;
+          // compute adjustment for Hochberg procedure
+          if(independence && idx_CDF == idx_last && s <= idx_transf && idx_transf < e)
+            pval_sum_last += support[r];
+        });
+        ws.counts[idx_CDF] = 0;
+      }
+
+      // find critical values
+      for(int a = 0; a < numAlpha; a++) {
+        double crit_a = points[find_crit(a)];
+        for(int i = idx_crit - count_pv + 1; i <= idx_crit; i++) crit[i + (size_t)a * numTests] = crit_a;
+      }
+
+      // save untransformed adjusted p-values
+      for(int i = idx_crit - count_pv + 1; i <= idx_crit; i++) {
+        if(points[idx_transf] == sorted_pv[idx_crit])
+          adjusted[i] = independence
+            ? std::min<double>(1.0, pval_sum_last)
+            : std::min<double>(1.0, sums[idx_transf]);
+      }
+
+      // go to next critical values
+      idx_crit -= count_pv;
+    }
+    after_block(idx_crit + 1, idx_crit + 1 + count_pv);
+  }
+
+  if(profile) {
+    profile->seconds_search += timer.lap();
+    profile->cdf_evaluations += evaluations;
+    profile->tie_blocks += num_blocks;
+    profile->working_bytes += ws.bytes();
+  }
+}
+
+// bounded approximation of the sums at sorted evaluation points (sorted
+// p-values or support values): the points are split into bins of
+// 'approx_bin_size' points, the sums are evaluated exactly at the boundaries
+// of the bins and bounded in between, as the CDFs (and the numbers of
+// p-values of a CDF that are not before a position) are monotone; the bounds
+// are computed with the same operations in the same order as the scans, so
+// that they also hold for the rounded sums
+struct approx_bounds {
+  approx_bounds() : bin(2), numGrid(0), numExact(0) {}
+
+  // number of points per bin and of bin boundaries, i.e. the points
+  // 'boundary(0)', ..., 'boundary(numGrid - 1)'
+  int bin, numGrid;
+  // lower and upper bounds of the untransformed sums at each point (equal at
+  // exactly evaluated points; under independence, the lower bound is the sum
+  // at the smaller point, i.e. the larger one of the logarithms)
+  std::vector<double> lower, upper;
+  // whether each point was evaluated exactly and their number
+  std::vector<char> exact;
+  int numExact;
+
+  // position of the boundary 'c'
+  inline int boundary(const int c) const {
+    return std::min<int>(c * bin, (int)lower.size() - 1);
+  }
+};
+
+// bounds of the untransformed sums at 'points[0]', ..., 'points[numValues -
+// 1]'; for stepwise procedures, the counts and (sorted, 1-based) indices of
+// the CDFs must be set, otherwise their counts
+inline approx_bounds approximate_sums(
+  const CDF_family &fam,
+  const double* points,
+  const int numValues,
+  const bool independence,
+  const bool single_step,
+  const int num_threads
+) {
+  approx_bounds bounds;
+  bounds.bin = approx_bin_size(numValues);
+  bounds.numGrid = numValues ? (numValues - 2 + bounds.bin) / bounds.bin + 1 : 0;
+  bounds.lower.assign(numValues, 0.0);
+  bounds.upper.assign(numValues, 0.0);
+  bounds.exact.assign(numValues, 0);
+  int numGrid = bounds.numGrid;
+  bool unit = unit_counts(fam);
+
+  // exact sums at the boundaries ('grid') and, for stepwise procedures,
+  // bounds within each bin
+  std::vector<double> grid(numGrid, 0.0), lo(numGrid, 0.0), hi(numGrid, 0.0);
+  if(single_step) {
+    std::vector<double> at(numGrid);
+    for(int c = 0; c < numGrid; c++) at[c] = points[bounds.boundary(c)];
+    parallel_ranges(numGrid, num_threads, [&](int a, int b) {
+      singlestep_sums(fam, 0, fam.numCDF, at.data(), a, b, independence, unit, false, grid.data());
+    });
+    for(int c = 0; c + 1 < numGrid; c++) {
+      lo[c] = grid[c];
+      hi[c] = grid[c + 1];
+    }
+  } else {
+    // the product of a CDF and the number of its p-values that are not
+    // before a position lies between those of the CDF at the start of a bin
+    // and the number at its end and vice versa
+    parallel_ranges(numGrid, num_threads, [&](int a, int b) {
+      for(int i = 0; i < fam.numCDF; i++) {
+        const double* vals = fam.vals[i];
+        int len = fam.lens[i];
+        int count = fam.counts[i];
+        const int* indices = fam.indices[i];
+        const double scale = fam.scales[i];
+        // number of CDF values <= the point at the current boundary and
+        // number of p-values of the CDF before it
+        int first = bounds.boundary(a);
+        int k = std::upper_bound(vals, vals + len, points[first], scaled_less(scale)) - vals;
+        int t = std::upper_bound(indices, indices + count, first) - indices;
+        double f_prev = 0, m_prev = 0;
+        for(int c = a; c <= std::min<int>(b, numGrid - 1); c++) {
+          int pos = bounds.boundary(c);
+          while(k < len && vals[k] / scale <= points[pos]) k++;
+          while(t < count && indices[t] <= pos) t++;
+          double f = k ? vals[k - 1] / scale : 0, m = (double)(count - t);
+          if(c > a) {
+            lo[c - 1] += f_prev * m;
+            hi[c - 1] += f * m_prev;
+          }
+          if(c < b) grid[c] += f * m;
+          f_prev = f;
+          m_prev = m;
+        }
+      }
+    });
+  }
+
+  for(int c = 0; c < numGrid; c++) {
+    int pos = bounds.boundary(c), end = c + 1 < numGrid ? bounds.boundary(c + 1) : pos + 1;
+    bounds.lower[pos] = bounds.upper[pos] = grid[c];
+    bounds.exact[pos] = 1;
+    for(int j = pos + 1; j < end; j++) {
+      bounds.lower[j] = lo[c];
+      bounds.upper[j] = hi[c];
+    }
+  }
+  bounds.numExact = numGrid;
+
+  return bounds;
+}
+
+// evaluates the sums within the bins 'bins[0]', ... exactly
+inline void refine_bins(
+  const CDF_family &fam,
+  const double* points,
+  const bool independence,
+  const bool single_step,
+  const std::vector<int> &bins,
+  const int num_threads,
+  approx_bounds &bounds
+) {
+  bool unit = unit_counts(fam);
+  parallel_ranges((int)bins.size(), num_threads, [&](int a, int b) {
+    for(int r = a; r < b; r++) {
+      int from = bounds.boundary(bins[r]) + 1, to = bounds.boundary(bins[r] + 1);
+      double* sums = bounds.lower.data();
+      std::fill(sums + from, sums + to, 0.0);
+      if(single_step)
+        singlestep_sums(fam, 0, fam.numCDF, points, from, to, independence, unit, false, sums);
+      else
+        stepwise_sums(fam, 0, fam.numCDF, points, from, to, unit, false, sums);
+      std::copy(sums + from, sums + to, bounds.upper.data() + from);
+      std::fill(bounds.exact.data() + from, bounds.exact.data() + to, 1);
+    }
+  });
+  for(size_t r = 0; r < bins.size(); r++)
+    bounds.numExact += bounds.boundary(bins[r] + 1) - bounds.boundary(bins[r]) - 1;
+}
+
+// tolerance of the decisions of the approximation: bounds that are closer to
+// an FWER level are evaluated exactly, so that rounding errors of the
+// transformations cannot change a decision
+const double approx_tolerance = 64 * std::numeric_limits<double>::epsilon();
+
+// transformed bounds at the points of 'bounds' ('lower' and 'upper'), in
+// which the sums are evaluated exactly, until the bounds determine for each
+// point and FWER level 'alpha[0]', ..., 'alpha[numAlpha - 1]' whether the
+// transformed sum there is greater than the level
+inline void resolve_bounds(
+  const CDF_family &fam,
+  const double* points,
+  const bool independence,
+  const bool single_step,
+  const double* alpha,
+  const int numAlpha,
+  const int num_threads,
+  approx_bounds &bounds,
+  double* lower,
+  double* upper
+) {
+  int numValues = (int)bounds.lower.size();
+  auto undecided = [&](double lo, double hi) {
+    if(lo == hi) return false;
+    for(int k = 0; k < numAlpha; k++)
+      if(lo <= alpha[k] + approx_tolerance && hi > alpha[k] - approx_tolerance) return true;
+    return false;
+  };
+
+  while(true) {
+    std::copy(bounds.lower.begin(), bounds.lower.end(), lower);
+    std::copy(bounds.upper.begin(), bounds.upper.end(), upper);
+    if(single_step) {
+      singlestep_transform(numValues, independence, lower);
+      singlestep_transform(numValues, independence, upper);
+    } else {
+      stepwise_transform(numValues, independence, lower);
+      stepwise_transform(numValues, independence, upper);
+    }
+
+    // bins of the undecided points that were not evaluated exactly
+    std::vector<int> bins;
+    bool open = false;
+    for(int j = 0; j < numValues; j++) {
+      if(!undecided(lower[j], upper[j])) continue;
+      open = true;
+      if(!bounds.exact[j] && (bins.empty() || bins.back() != j / bounds.bin)) bins.push_back(j / bounds.bin);
+    }
+    if(!open) break;
+    // the bounds of exactly evaluated points of stepwise procedures may be
+    // widened by those of other points; then all other bins are evaluated
+    if(bins.empty())
+      for(int c = 0; c + 1 < bounds.numGrid; c++)
+        if(!bounds.exact[bounds.boundary(c) + 1] && bounds.boundary(c) + 1 < bounds.boundary(c + 1)) bins.push_back(c);
+    refine_bins(fam, points, independence, single_step, bins, num_threads, bounds);
+  }
+}
+
+// approximate adjusted p-values at the sorted p-values 'sorted_pv[0]', ...,
+// 'sorted_pv[numTests - 1]', i.e. upper bounds whose distances to the lower
+// bounds (the certified errors) are written to 'errors'; the rejections at
+// the FWER levels 'alpha[0]', ..., 'alpha[numAlpha - 1]' are the same as
+// those of the exact adjusted p-values of a scan; returns the number of
+// exactly evaluated p-values
+inline int approximate_adjust(
+  const CDF_family &fam,
+  const double* sorted_pv,
+  const int numTests,
+  const bool independence,
+  const bool single_step,
+  const double* alpha,
+  const int numAlpha,
+  const int num_threads,
+  double* adjusted,
+  double* errors
+) {
+  if(numTests == 0) return 0;
+
+  approx_bounds bounds = approximate_sums(fam, sorted_pv, numTests, independence, single_step, num_threads);
+  resolve_bounds(fam, sorted_pv, independence, single_step, alpha, numAlpha, num_threads, bounds, errors, adjusted);
+  for(int j = 0; j < numTests; j++) errors[j] = adjusted[j] - errors[j];
+
+  return bounds.numExact;
+}
+
+// critical values of single-step procedures (written to 'crit') from the
+// approximation of the transformed active support; they are the same as
+// those of the exact transformed support, while the adjusted sorted p-values
+// (written to 'adjusted') are upper bounds whose certified errors are written
+// to 'errors'; returns the number of exactly evaluated support values
+inline int approximate_critical(
+  const CDF_family &fam,
+  const double* support,
+  const int numValues,
+  const int numActive,
+  const bool independence,
+  const double* alpha,
+  const int numAlpha,
+  const double* sorted_pv,
+  const int numTests,
+  const int num_threads,
+  double* crit,
+  double* adjusted,
+  double* errors
+) {
+  approx_bounds bounds = approximate_sums(fam, support, numActive, independence, true, num_threads);
+  std::vector<double> lower(numActive), upper(numActive), crit_lower(numAlpha);
+  resolve_bounds(fam, support, independence, true, alpha, numAlpha, num_threads, bounds, lower.data(), upper.data());
+  singlestep_critical(support, numValues, upper.data(), numActive, alpha, numAlpha, sorted_pv, numTests, crit, adjusted);
+  singlestep_critical(support, numValues, lower.data(), numActive, alpha, numAlpha, sorted_pv, numTests, crit_lower.data(), errors);
+  for(int i = 0; i < numTests; i++) errors[i] = adjusted[i] - errors[i];
+
+  return bounds.numExact;
+}
+
+// number of sorted p-values whose sums are evaluated by the first chunk of
+// 'early_rejections'; each further chunk is twice as large, so that the
+// evaluated p-values are at most twice as many as needed, while each CDF is
+// only searched once per chunk
+const int early_chunk_size = 256;
+
+// numbers of rejections of the FWER levels 'alpha[0]', ..., 'alpha[numAlpha -
+// 1]' (written to 'num_rejected') without computing all adjusted sorted
+// p-values; the evaluation stops as soon as the rejections of all levels are
+// determined: step-down procedures (d-Holm) evaluate the sums from the
+// smallest p-value until their running maximum exceeds all levels, step-up
+// procedures (d-Hochberg) from the largest one until their running minimum
+// does not exceed any level, and single-step procedures, whose sums grow with
+// the p-values, search the largest rejected p-value of each level by
+// bisection; the needed adjusted p-values are the same as those of a scan
+// and are written to 'adjusted' (all others are NaN); if a stepwise scan
+// would cost more than 'max_cost' operations (see 'choose_plan'), e.g. for a
+// step-up procedure with few rejections, all adjusted p-values are computed
+// by 'stepwise_adjust' instead (at the breakpoints, if 'breakpoints' is true);
+// for stepwise procedures, the counts and (sorted, 1-based) indices of the
+// CDFs must be set, otherwise their counts; returns the number of evaluated
+// p-values
+template<class Hook = no_block_hook>
+inline int early_rejections(
+  const CDF_family &fam,
+  const double* sorted_pv,
+  const int numTests,
+  const bool independence,
+  const bool single_step,
+  const double* alpha,
+  const int numAlpha,
+  const bool breakpoints,
+  const double max_cost,
+  const int num_threads,
+  double* adjusted,
+  int* num_rejected,
+  Hook after_block = Hook()
+) {
+  std::fill(adjusted, adjusted + numTests, std::numeric_limits<double>::quiet_NaN());
+  std::fill(num_rejected, num_rejected + numAlpha, 0);
+  if(numTests == 0 || numAlpha == 0) return 0;
+
+  // specialization of the sums for the counts
+  bool unit = unit_counts(fam);
+  double lowest = *std::min_element(alpha, alpha + numAlpha);
+  double highest = *std::max_element(alpha, alpha + numAlpha);
+  int evaluated = 0;
+
+  if(single_step) {
+    // adjusted p-value at a single sorted p-value (evaluated only once)
+    int block = CDF_block_size(1);
+    auto probe = [&](int j) {
+      if(std::isnan(adjusted[j])) {
+        adjusted[j] = 0;
+        for(int from = 0; from < fam.numCDF; from += block) {
+          int to = std::min<int>(fam.numCDF, from + block);
+          singlestep_sums(fam, from, to, sorted_pv, j, j + 1, independence, unit, false, adjusted);
+          after_block(from, to);
+        }
+        singlestep_transform(1, independence, adjusted + j);
+        evaluated++;
+      }
+      return adjusted[j];
+    };
+    // first p-value that is not rejected at each level
+    for(int a = 0; a < numAlpha; a++) {
+      int lo = 0, hi = numTests;
+      while(lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if(probe(mid) <= alpha[a]) lo = mid + 1; else hi = mid;
+      }
+      num_rejected[a] = lo;
+    }
+    return evaluated;
+  }
+
+  // a CDF contributes to the sums before its last p-value, so a scan of the
+  // p-values 'a', ..., 'b - 1' costs about (b - a) times the number of CDFs
+  // whose last p-value is after 'a'
+  std::vector<int> last(fam.numCDF);
+  for(int i = 0; i < fam.numCDF; i++) last[i] = fam.indices[i][fam.counts[i] - 1];
+  std::sort(last.begin(), last.end());
+  double cost = 0;
+  auto affordable = [&](int a, int b) {
+    int active = (int)(last.end() - std::upper_bound(last.begin(), last.end(), a));
+    cost += (double)active * (b - a);
+    return cost <= max_cost;
+  };
+  // sums of the sorted p-values 'a', ..., 'b - 1' (like 'stepwise_adjust')
+  auto evaluate = [&](int a, int b) {
+    std::fill(adjusted + a, adjusted + b, 0.0);
+    int block = CDF_block_size(b - a);
+    for(int from = 0; from < fam.numCDF; from += block) {
+      int to = std::min<int>(fam.numCDF, from + block);
+      parallel_ranges(b - a, num_threads, [&](int x, int y) {
+        stepwise_sums(fam, from, to, sorted_pv, a + x, a + y, unit, false, adjusted);
+      });
+      after_block(from, to);
+    }
+    evaluated += b - a;
+  };
+
+  // p-values 'first', ..., 'end - 1' whose adjusted p-values are known
+  int first = 0, end = 0, size = early_chunk_size;
+  bool complete = false;
+  if(independence) {
+    // step-up: running minimum from the top (like 'stepwise_transform') until
+    // it does not exceed the lowest level
+    first = end = numTests;
+    while(first > 0 && (first == numTests || !(adjusted[first] <= lowest))) {
+      int b = first, a = std::max<int>(0, b - size);
+      if(!affordable(a, b)) {
+        complete = true;
+        break;
+      }
+      evaluate(a, b);
+      for(int j = b - 1; j >= a; j--)
+        adjusted[j] = j == numTests - 1 ? std::min<double>(1.0, adjusted[j]) : std::min<double>(adjusted[j], adjusted[j + 1]);
+      first = a;
+      size *= 2;
+    }
+  } else {
+    // step-down: running maximum (like 'stepwise_transform') until it exceeds
+    // the highest level
+    while(end < numTests && !(end && adjusted[end - 1] > highest)) {
+      int a = end, b = std::min<int>(numTests, a + size);
+      if(!affordable(a, b)) {
+        complete = true;
+        break;
+      }
+      evaluate(a, b);
+      for(int j = a; j < b; j++) {
+        double sum = std::min<double>(1.0, adjusted[j]);
+        adjusted[j] = j ? std::max<double>(adjusted[j - 1], sum) : sum;
+      }
+      end = b;
+      size *= 2;
+    }
+  }
+
+  // stopping early does not pay off, so all adjusted p-values are computed
+  if(complete) {
+    stepwise_adjust(fam, sorted_pv, numTests, independence, breakpoints, num_threads, adjusted, after_block);
+    evaluated += numTests;
+    first = 0;
+    end = numTests;
+  }
+
+  for(int k = 0; k < numAlpha; k++) {
+    if(independence) {
+      // the largest rejected p-value is the last one whose adjusted p-value
+      // does not exceed the level
+      int j = end - 1;
+      while(j >= first && !(adjusted[j] <= alpha[k])) j--;
+      num_rejected[k] = j >= first ? j + 1 : 0;
+    } else {
+      // the first p-value that is not rejected is the first one whose
+      // adjusted p-value exceeds the level
+      int j = first;
+      while(j < end && !(adjusted[j] > alpha[k])) j++;
+      num_rejected[k] = j;
+    }
+  }
+
+  return evaluated;
+}
+
+// reusable buffers of 'adjust_pvalues', e.g. one per thread for analysing
+// many families
+struct adjust_workspace {
+  // sort order of the p-values and (0-based) position of each in it
+  std::vector<int> ord, pos;
+  std::vector<double> sorted_pv, adjusted;
+  // (1-based) sorted indices of all CDFs back to back (CSR layout)
+  std::vector<int> indices, offsets;
+};
+
+// complete analysis of a family without critical values: sorts the p-values
+// 'pvalues[0]', ..., 'pvalues[numTests - 1]', remaps the (1-based) indices of
+// the CDFs, which are given by 'fam.indices' and 'fam.counts' (if
+// 'fam.indices[i]' is NULL, the i-th CDF belongs to the i-th p-value), chooses
+// the evaluation strategy and writes the adjusted p-values in the original
+// order to 'adjusted'; returns the chosen plan
+inline kernel_plan adjust_pvalues(
+  const CDF_family &fam,
+  const double* pvalues,
+  const int numTests,
+  const bool independence,
+  const bool single_step,
+  const int num_threads,
+  double* adjusted,
+  adjust_workspace &ws
+) {
+  // sort order of the p-values (ties keep their order)
+  ws.ord.resize(numTests);
+  ws.pos.resize(numTests);
+  ws.sorted_pv.resize(numTests);
+  ws.adjusted.resize(numTests);
+  for(int i = 0; i < numTests; i++) ws.ord[i] = i;
+  std::stable_sort(ws.ord.begin(), ws.ord.end(), [&](int a, int b) {return pvalues[a] < pvalues[b];});
+  for(int j = 0; j < numTests; j++) {
+    ws.sorted_pv[j] = pvalues[ws.ord[j]];
+    ws.pos[ws.ord[j]] = j;
+  }
+
+  // sorted indices of the sorted p-values to which the CDFs belong
+  CDF_family sorted = fam;
+  ws.offsets.resize(fam.numCDF + 1);
+  ws.offsets[0] = 0;
+  for(int i = 0; i < fam.numCDF; i++)
+    ws.offsets[i + 1] = ws.offsets[i] + (fam.indices[i] ? fam.counts[i] : 1);
+  ws.indices.resize(ws.offsets[fam.numCDF]);
+  family_stats stats;
+  stats.num_cdfs = fam.numCDF;
+  stats.num_tests = numTests;
+  for(int i = 0; i < fam.numCDF; i++) {
+    int* idx = ws.indices.data() + ws.offsets[i];
+    int count = ws.offsets[i + 1] - ws.offsets[i];
+    for(int k = 0; k < count; k++)
+      idx[k] = ws.pos[fam.indices[i] ? fam.indices[i][k] - 1 : i] + 1;
+    std::sort(idx, idx + count);
+    sorted.counts[i] = count;
+    sorted.indices[i] = idx;
+    stats.num_values += fam.lens[i];
+    stats.scan_points += single_step ? numTests : idx[count - 1];
+  }
+  for(int j = 0; j < numTests; j++)
+    if(!j || ws.sorted_pv[j] != ws.sorted_pv[j - 1]) stats.num_distinct++;
+
+  // adjusted sorted p-values
+  kernel_plan plan = choose_plan(stats, false, single_step, num_threads);
+  if(single_step)
+    singlestep_adjust(sorted, ws.sorted_pv.data(), numTests, independence, plan.breakpoints, plan.num_threads, ws.adjusted.data());
+  else
+    stepwise_adjust(sorted, ws.sorted_pv.data(), numTests, independence, plan.breakpoints, plan.num_threads, ws.adjusted.data());
+
+  // adjusted p-values in the original order
+  for(int i = 0; i < numTests; i++) adjusted[i] = ws.adjusted[ws.pos[i]];
+
+  return plan;
+}
+
+} // namespace DiscreteFWER
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef DISCRETEFWER_SHARD_H
+#define DISCRETEFWER_SHARD_H
+
+// mergeable partial sums of single-step procedures (d-Bonferroni, d-Sidak) for
+// distributing the CDFs of a huge family over several processes or machines;
+// each worker computes the shard of its subset of the CDFs, the shards are
+// serialized, sent to a coordinator and merged there, before the adjusted
+// p-values and critical values are computed from the merged sums
+//
+// the sums of a subset of the CDFs form a step function that only jumps at
+// the values of these CDFs, so a shard stores its sums at its own support
+// values only and shards of different subsets can be merged without a common
+// evaluation grid; merging is associative, i.e. shards may also be merged in
+// a tree (the results may differ in the last bits from those of the whole
+// family due to the different order of summation)
+//
+// serialized layout (native byte order):
+//   header   magic "DFWERSHD", version, flags, limit, number of CDFs, number
+//            of p-values and number of support values
+//   points   double[numPoints], sorted support values of the CDFs up to the
+//            limit and the next larger one (if any)
+//   sums     double[numPoints], untransformed sums at these values
+
+#include "procedures.h"
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace DiscreteFWER {
+
+// flag of shards of independent p-values
+const uint32_t SHARD_INDEPENDENCE = 1;
+
+struct shard_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t flags;
+  double limit;
+  uint64_t numCDF;
+  uint64_t numTests;
+  uint64_t numPoints;
+};
+
+// partial sums of a subset of the CDFs of a family
+struct singlestep_shard {
+  singlestep_shard() : independence(false), limit(1), numCDF(0), numTests(0) {}
+
+  // whether the sums are those of independent p-values (i.e. of the
+  // logarithms of the complements of the CDFs)
+  bool independence;
+  // largest value at which the sums are needed, i.e. the largest FWER level
+  // or observed p-value
+  double limit;
+  // number of CDFs and of p-values to which they belong
+  uint64_t numCDF, numTests;
+  // support values of the CDFs and the sums there
+  std::vector<double> points, sums;
+};
+
+// shard of the CDFs of 'fam'; their counts must be set
+inline singlestep_shard make_shard(
+  const CDF_family &fam,
+  const bool independence,
+  const double limit,
+  const int num_threads
+) {
+  singlestep_shard shard;
+  shard.independence = independence;
+  shard.limit = limit;
+  shard.numCDF = fam.numCDF;
+  for(int i = 0; i < fam.numCDF; i++) shard.numTests += fam.counts[i];
+
+  // support values up to the limit and the next larger one
+  shard.points = merge_support(fam);
+  int numActive = active_support(shard.points.data(), (int)shard.points.size(), limit);
+  shard.points.resize(numActive);
+  shard.sums.resize(numActive);
+  if(numActive) {
+    CDF_ranks ranks(truncate_family(fam, shard.points[numActive - 1]), shard.points.data(), numActive);
+    singlestep_support_partial_sums(ranks, fam, shard.points.data(), numActive, independence, num_threads, shard.sums.data());
+  }
+
+  return shard;
+}
+
+// merges shards of disjoint subsets of the CDFs of a family, which must have
+// been computed for the same dependence mode and limit
+inline singlestep_shard merge_shards(const std::vector<const singlestep_shard*> &shards) {
+  if(shards.empty()) throw std::runtime_error("No shards to merge!");
+  singlestep_shard merged;
+  merged.independence = shards[0]->independence;
+  merged.limit = shards[0]->limit;
+  for(size_t s = 0; s < shards.size(); s++) {
+    if(shards[s]->independence != merged.independence || shards[s]->limit != merged.limit)
+      throw std::runtime_error("Shards must have the same dependence mode and limit!");
+    merged.numCDF += shards[s]->numCDF;
+    merged.numTests += shards[s]->numTests;
+  }
+
+  // union of the support values up to the limit and the next larger one
+  // (each shard's support is sorted, so they are merged in linear time)
+  for(size_t s = 0; s < shards.size(); s++) {
+    std::vector<double> points;
+    points.reserve(merged.points.size() + shards[s]->points.size());
+    std::set_union(merged.points.begin(), merged.points.end(), shards[s]->points.begin(), shards[s]->points.end(), std::back_inserter(points));
+    merged.points.swap(points);
+  }
+  int numPoints = active_support(merged.points.data(), (int)merged.points.size(), merged.limit);
+  merged.points.resize(numPoints);
+
+  // each shard contributes its sum at its largest support value that is not
+  // greater than the current one (or nothing, if there is none); the shards
+  // are added in their order, so the result does not depend on the union
+  merged.sums.assign(numPoints, 0.0);
+  for(size_t s = 0; s < shards.size(); s++) {
+    const std::vector<double> &points = shards[s]->points, &sums = shards[s]->sums;
+    size_t pos = 0;
+    for(int j = 0; j < numPoints; j++) {
+      while(pos < points.size() && points[pos] <= merged.points[j]) pos++;
+      if(pos) merged.sums[j] += sums[pos - 1];
+    }
+  }
+
+  return merged;
+}
+
+// critical values for the FWER levels 'alpha[0]', ..., 'alpha[numAlpha - 1]'
+// (written to 'crit') and adjusted sorted p-values (written to 'adjusted') of
+// a merged shard of all CDFs of a family
+inline void finalize_shard(
+  const singlestep_shard &shard,
+  const double* alpha,
+  const int numAlpha,
+  const double* sorted_pv,
+  const int numTests,
+  double* crit,
+  double* adjusted
+) {
+  int numPoints = (int)shard.points.size();
+  if(!numPoints) throw std::runtime_error("Shard has no support values!");
+  std::vector<double> support_transf(shard.sums);
+  singlestep_transform(numPoints, shard.independence, support_transf.data());
+  singlestep_critical(shard.points.data(), numPoints, support_transf.data(), numPoints, alpha, numAlpha, sorted_pv, numTests, crit, adjusted);
+}
+
+// binary representation of a shard
+inline std::vector<unsigned char> serialize_shard(const singlestep_shard &shard) {
+  shard_header header;
+  std::memcpy(header.magic, "DFWERSHD", 8);
+  header.version = 1;
+  header.flags = shard.independence ? SHARD_INDEPENDENCE : 0;
+  header.limit = shard.limit;
+  header.numCDF = shard.numCDF;
+  header.numTests = shard.numTests;
+  header.numPoints = shard.points.size();
+
+  size_t bytes = header.numPoints * sizeof(double);
+  std::vector<unsigned char> out(sizeof(header) + 2 * bytes);
+  std::memcpy(out.data(), &header, sizeof(header));
+  if(bytes) {
+    std::memcpy(out.data() + sizeof(header), shard.points.data(), bytes);
+    std::memcpy(out.data() + sizeof(header) + bytes, shard.sums.data(), bytes);
+  }
+
+  return out;
+}
+
+// shard from its binary representation; the number of support values must
+// match the size (without overflowing its computation), the limit must lie in
+// [0, 1] and the support values must increase (as merging relies on it)
+inline singlestep_shard deserialize_shard(const unsigned char* data, const size_t size) {
+  shard_header header;
+  if(size < sizeof(header)) throw std::runtime_error("Invalid shard!");
+  std::memcpy(&header, data, sizeof(header));
+  if(std::memcmp(header.magic, "DFWERSHD", 8) != 0 || header.version != 1 ||
+     header.numPoints > (size - sizeof(header)) / (2 * sizeof(double)) ||
+     size != sizeof(header) + 2 * header.numPoints * sizeof(double) ||
+     !(header.limit >= 0 && header.limit <= 1))
+    throw std::runtime_error("Invalid shard!");
+
+  singlestep_shard shard;
+  shard.independence = (header.flags & SHARD_INDEPENDENCE) != 0;
+  shard.limit = header.limit;
+  shard.numCDF = header.numCDF;
+  shard.numTests = header.numTests;
+  shard.points.resize(header.numPoints);
+  shard.sums.resize(header.numPoints);
+  size_t bytes = header.numPoints * sizeof(double);
+  if(bytes) {
+    std::memcpy(shard.points.data(), data + sizeof(header), bytes);
+    std::memcpy(shard.sums.data(), data + sizeof(header) + bytes, bytes);
+  }
+  for(size_t k = 1; k < shard.points.size(); k++)
+    if(!(shard.points[k] > shard.points[k - 1])) throw std::runtime_error("Invalid shard!");
+
+  return shard;
+}
+
+} // namespace DiscreteFWER
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef DISCRETEFWER_API_H
+#define DISCRETEFWER_API_H
+
+/*
+ * C-callable API of DiscreteFWER for other packages. Add 'DiscreteFWER' to
+ * 'LinkingTo' and 'Imports' in the DESCRIPTION file, include this header and
+ * make sure that the namespace of DiscreteFWER is loaded (e.g. by importing
+ * one of its functions). The functions only use plain arrays and do not call
+ * the R API, i.e. they may also be called from other threads. They return 0
+ * on success, 1 for invalid arguments (including missing p-values or FWER
+ * levels and values outside of [0, 1]) and -1 if memory could not be
+ * allocated; no exception ever leaves them.
+ *
+ * The p-value CDFs are given by the arrays 'vals[i]' of length 'lens[i]'
+ * (i = 0, ..., numCDF - 1), each sorted in increasing order with 1 as its
+ * last value. For R-independent C++ code, the headers in 'DiscreteFWER/'
+ * (e.g. 'DiscreteFWER/procedures.h') can be used directly instead; all of
+ * their names are in the namespace 'DiscreteFWER'.
+ */
+
+#include <R_ext/Rdynload.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Adjusted p-values of the discrete Bonferroni (single_step = 1,
+ * independence = 0), Sidak (1, 1), Holm (0, 0) and Hochberg (0, 1)
+ * procedures. 'pvalues' (in any order) and 'adjusted' have length 'numTests'.
+ * The i-th CDF belongs to the 'counts[i]' p-values with the (1-based) indices
+ * 'indices[i][0]', ..., each p-value to exactly one CDF; if 'indices' is NULL,
+ * the i-th CDF belongs to the i-th p-value ('counts' is ignored then).
+ */
+static inline int DiscreteFWER_adjust(
+  int numCDF, const double* const* vals, const int* lens, const int* counts,
+  const int* const* indices, int numTests, const double* pvalues,
+  int independence, int single_step, int num_threads, double* adjusted
+) {
+  typedef int (*fun_t)(int, const double* const*, const int*, const int*,
+    const int* const*, int, const double*, int, int, int, double*);
+  static fun_t fun = NULL;
+  if(fun == NULL)
+    fun = (fun_t) R_GetCCallable("DiscreteFWER", "DiscreteFWER_adjust");
+  return fun(numCDF, vals, lens, counts, indices, numTests, pvalues,
+    independence, single_step, num_threads, adjusted);
+}
+
+/*
+ * Critical values of the discrete Bonferroni (independence = 0) and Sidak (1)
+ * procedures for the FWER levels 'alpha[0]', ..., 'alpha[numAlpha - 1]'
+ * (written to 'crit') and the adjusted p-values at the p-values 'sorted_pv',
+ * which must be sorted in increasing order (written to 'adjusted'); 'counts[i]' is the number of p-values
+ * to which the i-th CDF belongs (1 for each CDF, if 'counts' is NULL).
+ */
+static inline int DiscreteFWER_singlestep_critical(
+  int numCDF, const double* const* vals, const int* lens, const int* counts,
+  int numTests, const double* sorted_pv, int numAlpha, const double* alpha,
+  int independence, int num_threads, double* crit, double* adjusted
+) {
+  typedef int (*fun_t)(int, const double* const*, const int*, const int*,
+    int, const double*, int, const double*, int, int, double*, double*);
+  static fun_t fun = NULL;
+  if(fun == NULL)
+    fun = (fun_t) R_GetCCallable("DiscreteFWER", "DiscreteFWER_singlestep_critical");
+  return fun(numCDF, vals, lens, counts, numTests, sorted_pv, numAlpha, alpha,
+    independence, num_threads, crit, adjusted);
+}
+
+/*
+ * Critical values of the discrete Holm (independence = 0) and Hochberg (1)
+ * procedures for the FWER levels 'alpha[0]', ..., 'alpha[numAlpha - 1]' at
+ * each of the 'numTests' p-values 'sorted_pv', which must be sorted in
+ * increasing order (written column by column to the 'numTests' x 'numAlpha'
+ * array 'crit'), and the adjusted p-values at the sorted p-values (written to
+ * 'adjusted'). The i-th CDF belongs to the 'counts[i]' sorted p-values with
+ * the (1-based) indices 'indices[i][0]', ..., each sorted p-value to exactly
+ * one CDF; if 'indices' is NULL, the i-th CDF belongs to the i-th sorted
+ * p-value ('counts' is ignored then).
+ */
+static inline int DiscreteFWER_stepwise_critical(
+  int numCDF, const double* const* vals, const int* lens, const int* counts,
+  const int* const* indices, int numTests, const double* sorted_pv,
+  int numAlpha, const double* alpha, int independence, double* crit,
+  double* adjusted
+) {
+  typedef int (*fun_t)(int, const double* const*, const int*, const int*,
+    const int* const*, int, const double*, int, const double*, int, double*,
+    double*);
+  static fun_t fun = NULL;
+  if(fun == NULL)
+    fun = (fun_t) R_GetCCallable("DiscreteFWER", "DiscreteFWER_stepwise_critical");
+  return fun(numCDF, vals, lens, counts, indices, numTests, sorted_pv,
+    numAlpha, alpha, independence, crit, adjusted);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
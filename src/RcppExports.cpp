@@ -12,75 +12,332 @@ Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
 // kernel_DFWER_singlestep_fast
-NumericVector kernel_DFWER_singlestep_fast(const List& pCDFlist, const NumericVector& pvalues, const bool independence, const Nullable<IntegerVector>& pCDFcounts);
-RcppExport SEXP _DiscreteFWER_kernel_DFWER_singlestep_fast(SEXP pCDFlistSEXP, SEXP pvaluesSEXP, SEXP independenceSEXP, SEXP pCDFcountsSEXP) {
+NumericVector kernel_DFWER_singlestep_fast(const SEXP pCDFlist, const NumericVector& pvalues, const bool independence, const Nullable<IntegerVector>& pCDFcounts, const bool breakpoints, const int num_threads, const Nullable<NumericVector>& pCDFscales);
+RcppExport SEXP _DiscreteFWER_kernel_DFWER_singlestep_fast(SEXP pCDFlistSEXP, SEXP pvaluesSEXP, SEXP independenceSEXP, SEXP pCDFcountsSEXP, SEXP breakpointsSEXP, SEXP num_threadsSEXP, SEXP pCDFscalesSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    Rcpp::traits::input_parameter< const SEXP >::type pCDFlist(pCDFlistSEXP);
     Rcpp::traits::input_parameter< const NumericVector& >::type pvalues(pvaluesSEXP);
     Rcpp::traits::input_parameter< const bool >::type independence(independenceSEXP);
     Rcpp::traits::input_parameter< const Nullable<IntegerVector>& >::type pCDFcounts(pCDFcountsSEXP);
-    rcpp_result_gen = Rcpp::wrap(kernel_DFWER_singlestep_fast(pCDFlist, pvalues, independence, pCDFcounts));
+    Rcpp::traits::input_parameter< const bool >::type breakpoints(breakpointsSEXP);
+    Rcpp::traits::input_parameter< const int >::type num_threads(num_threadsSEXP);
+    Rcpp::traits::input_parameter< const Nullable<NumericVector>& >::type pCDFscales(pCDFscalesSEXP);
+    rcpp_result_gen = Rcpp::wrap(kernel_DFWER_singlestep_fast(pCDFlist, pvalues, independence, pCDFcounts, breakpoints, num_threads, pCDFscales));
     return rcpp_result_gen;
 END_RCPP
 }
 // kernel_DFWER_singlestep_crit
-List kernel_DFWER_singlestep_crit(const List& pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const double alpha, const bool independence, const Nullable<IntegerVector>& pCDFcounts);
-RcppExport SEXP _DiscreteFWER_kernel_DFWER_singlestep_crit(SEXP pCDFlistSEXP, SEXP supportSEXP, SEXP sorted_pvSEXP, SEXP alphaSEXP, SEXP independenceSEXP, SEXP pCDFcountsSEXP) {
+List kernel_DFWER_singlestep_crit(const SEXP pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const NumericVector& alpha, const bool independence, const Nullable<IntegerVector>& pCDFcounts, const int num_threads, const Nullable<NumericVector>& pCDFscales);
+RcppExport SEXP _DiscreteFWER_kernel_DFWER_singlestep_crit(SEXP pCDFlistSEXP, SEXP supportSEXP, SEXP sorted_pvSEXP, SEXP alphaSEXP, SEXP independenceSEXP, SEXP pCDFcountsSEXP, SEXP num_threadsSEXP, SEXP pCDFscalesSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    Rcpp::traits::input_parameter< const SEXP >::type pCDFlist(pCDFlistSEXP);
     Rcpp::traits::input_parameter< const NumericVector& >::type support(supportSEXP);
     Rcpp::traits::input_parameter< const NumericVector& >::type sorted_pv(sorted_pvSEXP);
-    Rcpp::traits::input_parameter< const double >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type alpha(alphaSEXP);
     Rcpp::traits::input_parameter< const bool >::type independence(independenceSEXP);
     Rcpp::traits::input_parameter< const Nullable<IntegerVector>& >::type pCDFcounts(pCDFcountsSEXP);
-    rcpp_result_gen = Rcpp::wrap(kernel_DFWER_singlestep_crit(pCDFlist, support, sorted_pv, alpha, independence, pCDFcounts));
+    Rcpp::traits::input_parameter< const int >::type num_threads(num_threadsSEXP);
+    Rcpp::traits::input_parameter< const Nullable<NumericVector>& >::type pCDFscales(pCDFscalesSEXP);
+    rcpp_result_gen = Rcpp::wrap(kernel_DFWER_singlestep_crit(pCDFlist, support, sorted_pv, alpha, independence, pCDFcounts, num_threads, pCDFscales));
     return rcpp_result_gen;
 END_RCPP
 }
 // kernel_DFWER_stepwise_fast
-NumericVector kernel_DFWER_stepwise_fast(const List& pCDFlist, const NumericVector& sorted_pv, const bool independence, const Nullable<List>& pCDFindices);
-RcppExport SEXP _DiscreteFWER_kernel_DFWER_stepwise_fast(SEXP pCDFlistSEXP, SEXP sorted_pvSEXP, SEXP independenceSEXP, SEXP pCDFindicesSEXP) {
+NumericVector kernel_DFWER_stepwise_fast(const SEXP pCDFlist, const NumericVector& sorted_pv, const bool independence, const Nullable<List>& pCDFindices, const bool breakpoints, const int num_threads, const Nullable<NumericVector>& pCDFscales);
+RcppExport SEXP _DiscreteFWER_kernel_DFWER_stepwise_fast(SEXP pCDFlistSEXP, SEXP sorted_pvSEXP, SEXP independenceSEXP, SEXP pCDFindicesSEXP, SEXP breakpointsSEXP, SEXP num_threadsSEXP, SEXP pCDFscalesSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    Rcpp::traits::input_parameter< const SEXP >::type pCDFlist(pCDFlistSEXP);
     Rcpp::traits::input_parameter< const NumericVector& >::type sorted_pv(sorted_pvSEXP);
     Rcpp::traits::input_parameter< const bool >::type independence(independenceSEXP);
     Rcpp::traits::input_parameter< const Nullable<List>& >::type pCDFindices(pCDFindicesSEXP);
-    rcpp_result_gen = Rcpp::wrap(kernel_DFWER_stepwise_fast(pCDFlist, sorted_pv, independence, pCDFindices));
+    Rcpp::traits::input_parameter< const bool >::type breakpoints(breakpointsSEXP);
+    Rcpp::traits::input_parameter< const int >::type num_threads(num_threadsSEXP);
+    Rcpp::traits::input_parameter< const Nullable<NumericVector>& >::type pCDFscales(pCDFscalesSEXP);
+    rcpp_result_gen = Rcpp::wrap(kernel_DFWER_stepwise_fast(pCDFlist, sorted_pv, independence, pCDFindices, breakpoints, num_threads, pCDFscales));
     return rcpp_result_gen;
 END_RCPP
 }
 // kernel_DFWER_stepwise_crit
-List kernel_DFWER_stepwise_crit(const List& pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const double alpha, const bool independence, const Nullable<List>& pCDFindices);
-RcppExport SEXP _DiscreteFWER_kernel_DFWER_stepwise_crit(SEXP pCDFlistSEXP, SEXP supportSEXP, SEXP sorted_pvSEXP, SEXP alphaSEXP, SEXP independenceSEXP, SEXP pCDFindicesSEXP) {
+List kernel_DFWER_stepwise_crit(const SEXP pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const NumericVector& alpha, const bool independence, const Nullable<List>& pCDFindices, const Nullable<NumericVector>& pCDFscales);
+RcppExport SEXP _DiscreteFWER_kernel_DFWER_stepwise_crit(SEXP pCDFlistSEXP, SEXP supportSEXP, SEXP sorted_pvSEXP, SEXP alphaSEXP, SEXP independenceSEXP, SEXP pCDFindicesSEXP, SEXP pCDFscalesSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    Rcpp::traits::input_parameter< const SEXP >::type pCDFlist(pCDFlistSEXP);
     Rcpp::traits::input_parameter< const NumericVector& >::type support(supportSEXP);
     Rcpp::traits::input_parameter< const NumericVector& >::type sorted_pv(sorted_pvSEXP);
-    Rcpp::traits::input_parameter< const double >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type independence(independenceSEXP);
+    Rcpp::traits::input_parameter< const Nullable<List>& >::type pCDFindices(pCDFindicesSEXP);
+    Rcpp::traits::input_parameter< const Nullable<NumericVector>& >::type pCDFscales(pCDFscalesSEXP);
+    rcpp_result_gen = Rcpp::wrap(kernel_DFWER_stepwise_crit(pCDFlist, support, sorted_pv, alpha, independence, pCDFindices, pCDFscales));
+    return rcpp_result_gen;
+END_RCPP
+}
+// prepare_family_int
+SEXP prepare_family_int(const List& pCDFlist);
+RcppExport SEXP _DiscreteFWER_prepare_family_int(SEXP pCDFlistSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    rcpp_result_gen = Rcpp::wrap(prepare_family_int(pCDFlist));
+    return rcpp_result_gen;
+END_RCPP
+}
+// prepared_valid
+bool prepared_valid(const SEXP family);
+RcppExport SEXP _DiscreteFWER_prepared_valid(SEXP familySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const SEXP >::type family(familySEXP);
+    rcpp_result_gen = Rcpp::wrap(prepared_valid(family));
+    return rcpp_result_gen;
+END_RCPP
+}
+// prepared_support
+NumericVector prepared_support(const SEXP family);
+RcppExport SEXP _DiscreteFWER_prepared_support(SEXP familySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const SEXP >::type family(familySEXP);
+    rcpp_result_gen = Rcpp::wrap(prepared_support(family));
+    return rcpp_result_gen;
+END_RCPP
+}
+// write_CDF_store_int
+void write_CDF_store_int(const List& pCDFlist, const std::string& file, const Nullable<List>& pCDFindices);
+RcppExport SEXP _DiscreteFWER_write_CDF_store_int(SEXP pCDFlistSEXP, SEXP fileSEXP, SEXP pCDFindicesSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< const Nullable<List>& >::type pCDFindices(pCDFindicesSEXP);
+    write_CDF_store_int(pCDFlist, file, pCDFindices);
+    return R_NilValue;
+END_RCPP
+}
+// CDF_store_info
+List CDF_store_info(const std::string& file);
+RcppExport SEXP _DiscreteFWER_CDF_store_info(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(CDF_store_info(file));
+    return rcpp_result_gen;
+END_RCPP
+}
+// discrete_fwer_native
+List discrete_fwer_native(const SEXP pCDFlist, const NumericVector& pvalues, const Nullable<List>& pCDFindices, const NumericVector& alpha, const bool independence, const bool single_step, const bool crit_consts, const int num_threads, const Nullable<NumericVector>& pCDFscales, const bool profile, const std::string& engine);
+RcppExport SEXP _DiscreteFWER_discrete_fwer_native(SEXP pCDFlistSEXP, SEXP pvaluesSEXP, SEXP pCDFindicesSEXP, SEXP alphaSEXP, SEXP independenceSEXP, SEXP single_stepSEXP, SEXP crit_constsSEXP, SEXP num_threadsSEXP, SEXP pCDFscalesSEXP, SEXP profileSEXP, SEXP engineSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const SEXP >::type pCDFlist(pCDFlistSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type pvalues(pvaluesSEXP);
+    Rcpp::traits::input_parameter< const Nullable<List>& >::type pCDFindices(pCDFindicesSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type independence(independenceSEXP);
+    Rcpp::traits::input_parameter< const bool >::type single_step(single_stepSEXP);
+    Rcpp::traits::input_parameter< const bool >::type crit_consts(crit_constsSEXP);
+    Rcpp::traits::input_parameter< const int >::type num_threads(num_threadsSEXP);
+    Rcpp::traits::input_parameter< const Nullable<NumericVector>& >::type pCDFscales(pCDFscalesSEXP);
+    Rcpp::traits::input_parameter< const bool >::type profile(profileSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type engine(engineSEXP);
+    rcpp_result_gen = Rcpp::wrap(discrete_fwer_native(pCDFlist, pvalues, pCDFindices, alpha, independence, single_step, crit_consts, num_threads, pCDFscales, profile, engine));
+    return rcpp_result_gen;
+END_RCPP
+}
+// match_pvals_int
+List match_pvals_int(const NumericVector& pvalues, const List& pCDFlist, const Nullable<List>& pCDFindices);
+RcppExport SEXP _DiscreteFWER_match_pvals_int(SEXP pvaluesSEXP, SEXP pCDFlistSEXP, SEXP pCDFindicesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const NumericVector& >::type pvalues(pvaluesSEXP);
+    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    Rcpp::traits::input_parameter< const Nullable<List>& >::type pCDFindices(pCDFindicesSEXP);
+    rcpp_result_gen = Rcpp::wrap(match_pvals_int(pvalues, pCDFlist, pCDFindices));
+    return rcpp_result_gen;
+END_RCPP
+}
+// eval_CDFs_int
+NumericVector eval_CDFs_int(const List& pCDFlist, const double x);
+RcppExport SEXP _DiscreteFWER_eval_CDFs_int(SEXP pCDFlistSEXP, SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    Rcpp::traits::input_parameter< const double >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(eval_CDFs_int(pCDFlist, x));
+    return rcpp_result_gen;
+END_RCPP
+}
+// deduplicate_CDFs_int
+List deduplicate_CDFs_int(const List& pCDFlist);
+RcppExport SEXP _DiscreteFWER_deduplicate_CDFs_int(SEXP pCDFlistSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    rcpp_result_gen = Rcpp::wrap(deduplicate_CDFs_int(pCDFlist));
+    return rcpp_result_gen;
+END_RCPP
+}
+// discrete_fwer_batch_int
+List discrete_fwer_batch_int(const List& families, const NumericVector& alpha, const bool independence, const bool single_step, const int num_threads);
+RcppExport SEXP _DiscreteFWER_discrete_fwer_batch_int(SEXP familiesSEXP, SEXP alphaSEXP, SEXP independenceSEXP, SEXP single_stepSEXP, SEXP num_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const List& >::type families(familiesSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type independence(independenceSEXP);
+    Rcpp::traits::input_parameter< const bool >::type single_step(single_stepSEXP);
+    Rcpp::traits::input_parameter< const int >::type num_threads(num_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(discrete_fwer_batch_int(families, alpha, independence, single_step, num_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// singlestep_shard_int
+RawVector singlestep_shard_int(const List& pCDFlist, const Nullable<IntegerVector>& pCDFcounts, const bool independence, const double limit, const int num_threads);
+RcppExport SEXP _DiscreteFWER_singlestep_shard_int(SEXP pCDFlistSEXP, SEXP pCDFcountsSEXP, SEXP independenceSEXP, SEXP limitSEXP, SEXP num_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    Rcpp::traits::input_parameter< const Nullable<IntegerVector>& >::type pCDFcounts(pCDFcountsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type independence(independenceSEXP);
+    Rcpp::traits::input_parameter< const double >::type limit(limitSEXP);
+    Rcpp::traits::input_parameter< const int >::type num_threads(num_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(singlestep_shard_int(pCDFlist, pCDFcounts, independence, limit, num_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// merge_shards_int
+RawVector merge_shards_int(const List& shards);
+RcppExport SEXP _DiscreteFWER_merge_shards_int(SEXP shardsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const List& >::type shards(shardsSEXP);
+    rcpp_result_gen = Rcpp::wrap(merge_shards_int(shards));
+    return rcpp_result_gen;
+END_RCPP
+}
+// finalize_shard_int
+List finalize_shard_int(const RawVector& shard, const NumericVector& sorted_pv, const NumericVector& alpha);
+RcppExport SEXP _DiscreteFWER_finalize_shard_int(SEXP shardSEXP, SEXP sorted_pvSEXP, SEXP alphaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const RawVector& >::type shard(shardSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type sorted_pv(sorted_pvSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type alpha(alphaSEXP);
+    rcpp_result_gen = Rcpp::wrap(finalize_shard_int(shard, sorted_pv, alpha));
+    return rcpp_result_gen;
+END_RCPP
+}
+// shard_info_int
+List shard_info_int(const RawVector& shard);
+RcppExport SEXP _DiscreteFWER_shard_info_int(SEXP shardSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const RawVector& >::type shard(shardSEXP);
+    rcpp_result_gen = Rcpp::wrap(shard_info_int(shard));
+    return rcpp_result_gen;
+END_RCPP
+}
+// incremental_create_int
+SEXP incremental_create_int(const bool independence, const bool single_step);
+RcppExport SEXP _DiscreteFWER_incremental_create_int(SEXP independenceSEXP, SEXP single_stepSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< const bool >::type independence(independenceSEXP);
+    Rcpp::traits::input_parameter< const bool >::type single_step(single_stepSEXP);
+    rcpp_result_gen = Rcpp::wrap(incremental_create_int(independence, single_step));
+    return rcpp_result_gen;
+END_RCPP
+}
+// incremental_valid
+bool incremental_valid(const SEXP family);
+RcppExport SEXP _DiscreteFWER_incremental_valid(SEXP familySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const SEXP >::type family(familySEXP);
+    rcpp_result_gen = Rcpp::wrap(incremental_valid(family));
+    return rcpp_result_gen;
+END_RCPP
+}
+// incremental_append_int
+void incremental_append_int(const SEXP family, const List& pCDFlist, const NumericVector& pvalues, const Nullable<List>& pCDFindices, const int num_threads);
+RcppExport SEXP _DiscreteFWER_incremental_append_int(SEXP familySEXP, SEXP pCDFlistSEXP, SEXP pvaluesSEXP, SEXP pCDFindicesSEXP, SEXP num_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const SEXP >::type family(familySEXP);
+    Rcpp::traits::input_parameter< const List& >::type pCDFlist(pCDFlistSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type pvalues(pvaluesSEXP);
     Rcpp::traits::input_parameter< const Nullable<List>& >::type pCDFindices(pCDFindicesSEXP);
-    rcpp_result_gen = Rcpp::wrap(kernel_DFWER_stepwise_crit(pCDFlist, support, sorted_pv, alpha, independence, pCDFindices));
+    Rcpp::traits::input_parameter< const int >::type num_threads(num_threadsSEXP);
+    incremental_append_int(family, pCDFlist, pvalues, pCDFindices, num_threads);
+    return R_NilValue;
+END_RCPP
+}
+// incremental_results_int
+List incremental_results_int(const SEXP family, const NumericVector& alpha, const bool crit_consts);
+RcppExport SEXP _DiscreteFWER_incremental_results_int(SEXP familySEXP, SEXP alphaSEXP, SEXP crit_constsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const SEXP >::type family(familySEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type crit_consts(crit_constsSEXP);
+    rcpp_result_gen = Rcpp::wrap(incremental_results_int(family, alpha, crit_consts));
     return rcpp_result_gen;
 END_RCPP
 }
 
+void DiscreteFWER_register_api(DllInfo* dll);
 static const R_CallMethodDef CallEntries[] = {
-    {"_DiscreteFWER_kernel_DFWER_singlestep_fast", (DL_FUNC) &_DiscreteFWER_kernel_DFWER_singlestep_fast, 4},
-    {"_DiscreteFWER_kernel_DFWER_singlestep_crit", (DL_FUNC) &_DiscreteFWER_kernel_DFWER_singlestep_crit, 6},
-    {"_DiscreteFWER_kernel_DFWER_stepwise_fast", (DL_FUNC) &_DiscreteFWER_kernel_DFWER_stepwise_fast, 4},
-    {"_DiscreteFWER_kernel_DFWER_stepwise_crit", (DL_FUNC) &_DiscreteFWER_kernel_DFWER_stepwise_crit, 6},
+    {"_DiscreteFWER_kernel_DFWER_singlestep_fast", (DL_FUNC) &_DiscreteFWER_kernel_DFWER_singlestep_fast, 7},
+    {"_DiscreteFWER_kernel_DFWER_singlestep_crit", (DL_FUNC) &_DiscreteFWER_kernel_DFWER_singlestep_crit, 8},
+    {"_DiscreteFWER_kernel_DFWER_stepwise_fast", (DL_FUNC) &_DiscreteFWER_kernel_DFWER_stepwise_fast, 7},
+    {"_DiscreteFWER_kernel_DFWER_stepwise_crit", (DL_FUNC) &_DiscreteFWER_kernel_DFWER_stepwise_crit, 7},
+    {"_DiscreteFWER_prepare_family_int", (DL_FUNC) &_DiscreteFWER_prepare_family_int, 1},
+    {"_DiscreteFWER_prepared_valid", (DL_FUNC) &_DiscreteFWER_prepared_valid, 1},
+    {"_DiscreteFWER_prepared_support", (DL_FUNC) &_DiscreteFWER_prepared_support, 1},
+    {"_DiscreteFWER_write_CDF_store_int", (DL_FUNC) &_DiscreteFWER_write_CDF_store_int, 3},
+    {"_DiscreteFWER_CDF_store_info", (DL_FUNC) &_DiscreteFWER_CDF_store_info, 1},
+    {"_DiscreteFWER_discrete_fwer_native", (DL_FUNC) &_DiscreteFWER_discrete_fwer_native, 11},
+    {"_DiscreteFWER_match_pvals_int", (DL_FUNC) &_DiscreteFWER_match_pvals_int, 3},
+    {"_DiscreteFWER_eval_CDFs_int", (DL_FUNC) &_DiscreteFWER_eval_CDFs_int, 2},
+    {"_DiscreteFWER_deduplicate_CDFs_int", (DL_FUNC) &_DiscreteFWER_deduplicate_CDFs_int, 1},
+    {"_DiscreteFWER_discrete_fwer_batch_int", (DL_FUNC) &_DiscreteFWER_discrete_fwer_batch_int, 5},
+    {"_DiscreteFWER_singlestep_shard_int", (DL_FUNC) &_DiscreteFWER_singlestep_shard_int, 5},
+    {"_DiscreteFWER_merge_shards_int", (DL_FUNC) &_DiscreteFWER_merge_shards_int, 1},
+    {"_DiscreteFWER_finalize_shard_int", (DL_FUNC) &_DiscreteFWER_finalize_shard_int, 3},
+    {"_DiscreteFWER_shard_info_int", (DL_FUNC) &_DiscreteFWER_shard_info_int, 1},
+    {"_DiscreteFWER_incremental_create_int", (DL_FUNC) &_DiscreteFWER_incremental_create_int, 2},
+    {"_DiscreteFWER_incremental_valid", (DL_FUNC) &_DiscreteFWER_incremental_valid, 1},
+    {"_DiscreteFWER_incremental_append_int", (DL_FUNC) &_DiscreteFWER_incremental_append_int, 5},
+    {"_DiscreteFWER_incremental_results_int", (DL_FUNC) &_DiscreteFWER_incremental_results_int, 3},
     {NULL, NULL, 0}
 };
 
 RcppExport void R_init_DiscreteFWER(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    DiscreteFWER_register_api(dll);
 }
@@ -0,0 +1,216 @@
+#include "kernel.h"
+#include <R_ext/Rdynload.h>
+
+// C-callable API of the package for other packages (see
+// 'inst/include/DiscreteFWER_API.h'); the functions only use plain arrays,
+// do not use the R API and never throw, i.e. they may be called from any
+// thread; they return 0 on success, 1 for invalid arguments and -1 if memory
+// could not be allocated
+
+// whether all values are (non-missing) probabilities and, if requested, sorted
+// in increasing order
+static bool api_probabilities(const double* x, const int n, const bool sorted = false) {
+  if(x == NULL || n < 1) return false;
+  for(int i = 0; i < n; i++) {
+    // also false for NaN
+    if(!(x[i] >= 0 && x[i] <= 1)) return false;
+    if(sorted && i > 0 && x[i] < x[i - 1]) return false;
+  }
+  return true;
+}
+
+// plain view of a family given by arrays, if it is valid
+static bool api_family(
+  const int numCDF,
+  const double* const* vals,
+  const int* lens,
+  CDF_family &fam
+) {
+  if(numCDF < 1 || vals == NULL || lens == NULL) return false;
+  for(int i = 0; i < numCDF; i++) {
+    if(vals[i] == NULL || lens[i] < 1) return false;
+    fam.vals[i] = vals[i];
+    fam.lens[i] = CDF_length(vals[i], lens[i]);
+  }
+  return true;
+}
+
+// counts and indices of the CDFs, if each p-value belongs to exactly one of
+// them (without indices, the i-th CDF belongs to the i-th p-value); if
+// 'sorted' is not NULL, the indices are copied to it and sorted for each CDF
+static bool api_indices(
+  const int numCDF,
+  const int* counts,
+  const int* const* indices,
+  const int numTests,
+  CDF_family &fam,
+  std::vector<int>* sorted = NULL
+) {
+  if(indices == NULL) {
+    if(numCDF != numTests) return false;
+    if(sorted) sorted->resize(numTests);
+    for(int i = 0; i < numCDF; i++) {
+      fam.counts[i] = 1;
+      if(sorted) {
+        (*sorted)[i] = i + 1;
+        fam.indices[i] = sorted->data() + i;
+      }
+    }
+    return true;
+  }
+
+  if(counts == NULL) return false;
+  std::vector<bool> seen(numTests, false);
+  int numSeen = 0;
+  for(int i = 0; i < numCDF; i++) {
+    if(indices[i] == NULL || counts[i] < 1) return false;
+    for(int k = 0; k < counts[i]; k++) {
+      int j = indices[i][k] - 1;
+      if(j < 0 || j >= numTests || seen[j]) return false;
+      seen[j] = true;
+      numSeen++;
+    }
+    fam.counts[i] = counts[i];
+    fam.indices[i] = indices[i];
+  }
+  if(numSeen != numTests) return false;
+
+  if(sorted) {
+    sorted->resize(numTests);
+    int* pos = sorted->data();
+    for(int i = 0; i < numCDF; i++) {
+      std::copy(indices[i], indices[i] + counts[i], pos);
+      std::sort(pos, pos + counts[i]);
+      fam.indices[i] = pos;
+      pos += counts[i];
+    }
+  }
+  return true;
+}
+
+extern "C" int DiscreteFWER_adjust(
+  const int numCDF,
+  const double* const* vals,
+  const int* lens,
+  const int* counts,
+  const int* const* indices,
+  const int numTests,
+  const double* pvalues,
+  const int independence,
+  const int single_step,
+  const int num_threads,
+  double* adjusted
+) {
+  // check everything that is needed for allocating before allocating anything
+  if(numCDF < 1 || !api_probabilities(pvalues, numTests) || adjusted == NULL) return 1;
+
+  try {
+    CDF_family fam(numCDF);
+    if(!api_family(numCDF, vals, lens, fam)) return 1;
+    // without indices, the i-th CDF belongs to the i-th p-value; otherwise,
+    // each p-value must belong to exactly one CDF
+    if(!api_indices(numCDF, counts, indices, numTests, fam)) return 1;
+
+    adjust_workspace ws;
+    adjust_pvalues(fam, pvalues, numTests, independence != 0, single_step != 0, std::max(1, num_threads), adjusted, ws);
+  } catch(std::bad_alloc&) {
+    return -1;
+  } catch(...) {
+    // no exception may leave the C interface
+    return 1;
+  }
+
+  return 0;
+}
+
+extern "C" int DiscreteFWER_singlestep_critical(
+  const int numCDF,
+  const double* const* vals,
+  const int* lens,
+  const int* counts,
+  const int numTests,
+  const double* sorted_pv,
+  const int numAlpha,
+  const double* alpha,
+  const int independence,
+  const int num_threads,
+  double* crit,
+  double* adjusted
+) {
+  if(numCDF < 1 || !api_probabilities(sorted_pv, numTests, true) || !api_probabilities(alpha, numAlpha) || crit == NULL || adjusted == NULL) return 1;
+
+  try {
+    CDF_family fam(numCDF);
+    if(!api_family(numCDF, vals, lens, fam)) return 1;
+    for(int i = 0; i < numCDF; i++) {
+      if(counts && counts[i] < 1) return 1;
+      fam.counts[i] = counts ? counts[i] : 1;
+    }
+
+    // overall support; only the values up to the largest FWER level or
+    // observed p-value (and the next larger one) are needed
+    std::vector<double> support = merge_support(fam);
+    double limit = std::max<double>(*std::max_element(alpha, alpha + numAlpha), sorted_pv[numTests - 1]);
+    int numActive = active_support(support.data(), (int)support.size(), limit);
+    CDF_ranks ranks(truncate_family(fam, support[numActive - 1]), support.data(), numActive);
+
+    std::vector<double> support_transf(numActive);
+    singlestep_support_sums(ranks, fam, support.data(), numActive, independence != 0, std::max(1, num_threads), support_transf.data());
+    singlestep_critical(support.data(), (int)support.size(), support_transf.data(), numActive, alpha, numAlpha, sorted_pv, numTests, crit, adjusted);
+  } catch(std::bad_alloc&) {
+    return -1;
+  } catch(...) {
+    // no exception may leave the C interface
+    return 1;
+  }
+
+  return 0;
+}
+
+extern "C" int DiscreteFWER_stepwise_critical(
+  const int numCDF,
+  const double* const* vals,
+  const int* lens,
+  const int* counts,
+  const int* const* indices,
+  const int numTests,
+  const double* sorted_pv,
+  const int numAlpha,
+  const double* alpha,
+  const int independence,
+  double* crit,
+  double* adjusted
+) {
+  if(numCDF < 1 || !api_probabilities(sorted_pv, numTests, true) || !api_probabilities(alpha, numAlpha) || crit == NULL || adjusted == NULL) return 1;
+
+  try {
+    CDF_family fam(numCDF);
+    std::vector<int> sorted_indices;
+    if(!api_family(numCDF, vals, lens, fam) || !api_indices(numCDF, counts, indices, numTests, fam, &sorted_indices)) return 1;
+
+    // overall support and the values of it that are needed (like above)
+    std::vector<double> support = merge_support(fam);
+    double limit = std::max<double>(*std::max_element(alpha, alpha + numAlpha), sorted_pv[numTests - 1]);
+    int numActive = active_support(support.data(), (int)support.size(), limit);
+
+    critical_workspace ws;
+    ws.ranks.assign(truncate_family(fam, support[numActive - 1]), support.data(), numActive);
+    stepwise_critical(ws.ranks, fam, support.data(), (int)support.size(), numActive, sorted_pv, numTests, alpha, numAlpha, independence != 0, crit, adjusted, ws);
+  } catch(std::bad_alloc&) {
+    return -1;
+  } catch(...) {
+    return 1;
+  }
+
+  return 0;
+}
+
+// registers the C-callable API when the package is loaded
+// [[Rcpp::init]]
+void DiscreteFWER_register_api(DllInfo* dll) {
+  // the routines of the package are registered by RcppExports.cpp
+  (void)dll;
+  R_RegisterCCallable("DiscreteFWER", "DiscreteFWER_adjust", (DL_FUNC) &DiscreteFWER_adjust);
+  R_RegisterCCallable("DiscreteFWER", "DiscreteFWER_singlestep_critical", (DL_FUNC) &DiscreteFWER_singlestep_critical);
+  R_RegisterCCallable("DiscreteFWER", "DiscreteFWER_stepwise_critical", (DL_FUNC) &DiscreteFWER_stepwise_critical);
+}
@@ -0,0 +1,146 @@
+#include "kernel.h"
+
+// checks a p-value CDF of a family (1-based 'fam') and returns its values
+static NumericVector batch_CDF(const SEXP cdf, const int fam, const int i) {
+  if(!Rf_isNumeric(cdf))
+    stop("CDF %i of family %i is not numeric!", i, fam);
+  NumericVector vals(cdf);
+  int len = vals.length();
+  if(!len || vals[len - 1] != 1)
+    stop("CDF %i of family %i must have 1 as its largest value!", i, fam);
+  for(int k = 0; k < len; k++)
+    if(!(vals[k] >= 0 && vals[k] <= 1) || (k && vals[k] < vals[k - 1]))
+      stop("CDF %i of family %i must be sorted and in [0, 1]!", i, fam);
+
+  return vals;
+}
+
+List discrete_fwer_batch_int(
+  const List& families,
+  const NumericVector& alpha,
+  const bool independence,
+  const bool single_step,
+  const int num_threads
+) {
+  int numFamilies = families.length();
+  int numAlpha = alpha.length();
+
+  //--------------------------------------------
+  //        check families serially and keep
+  //        their vectors alive
+  //--------------------------------------------
+  std::vector<NumericVector> pvalues(numFamilies);
+  std::vector<std::vector<NumericVector> > cdfs(numFamilies);
+  std::vector<std::vector<IntegerVector> > indices(numFamilies);
+  std::vector<CDF_family> fams;
+  fams.reserve(numFamilies);
+  // estimated cost of each family
+  std::vector<double> cost(numFamilies);
+  for(int f = 0; f < numFamilies; f++) {
+    List family = families[f];
+    pvalues[f] = as<NumericVector>(family["pvalues"]);
+    List pCDFlist = family["pCDFlist"];
+    SEXP pCDFindices = family["pCDFindices"];
+    int numTests = pvalues[f].length();
+    int numCDF = pCDFlist.length();
+    if(!numTests) stop("Family %i has no p-values!", f + 1);
+    for(int j = 0; j < numTests; j++)
+      if(!(pvalues[f][j] >= 0 && pvalues[f][j] <= 1))
+        stop("P-values of family %i must be in [0, 1]!", f + 1);
+
+    fams.push_back(CDF_family(numCDF));
+    CDF_family &fam = fams.back();
+    cdfs[f].resize(numCDF);
+    for(int i = 0; i < numCDF; i++) {
+      cdfs[f][i] = batch_CDF(pCDFlist[i], f + 1, i + 1);
+      fam.vals[i] = cdfs[f][i].begin();
+      fam.lens[i] = cdfs[f][i].length();
+      cost[f] += fam.lens[i];
+    }
+
+    // without indices, the i-th CDF belongs to the i-th p-value; otherwise,
+    // the indices must be a partition of the p-values
+    if(Rf_isNull(pCDFindices)) {
+      if(numCDF != numTests)
+        stop("Family %i has %i p-values, but %i CDFs and no indices!", f + 1, numTests, numCDF);
+      for(int i = 0; i < numCDF; i++) fam.counts[i] = 1;
+    } else {
+      List idx_list(pCDFindices);
+      if(idx_list.length() != numCDF)
+        stop("Family %i must have one vector of indices per CDF!", f + 1);
+      std::vector<bool> seen(numTests, false);
+      int numSeen = 0;
+      indices[f].resize(numCDF);
+      for(int i = 0; i < numCDF; i++) {
+        indices[f][i] = as<IntegerVector>(idx_list[i]);
+        IntegerVector &idx = indices[f][i];
+        if(!idx.length()) stop("CDF %i of family %i belongs to no p-value!", i + 1, f + 1);
+        for(int k = 0; k < idx.length(); k++) {
+          if(idx[k] < 1 || idx[k] > numTests || seen[idx[k] - 1])
+            stop("Indices of family %i must be a partition of its p-values!", f + 1);
+          seen[idx[k] - 1] = true;
+          numSeen++;
+        }
+        fam.counts[i] = idx.length();
+        fam.indices[i] = idx.begin();
+      }
+      if(numSeen != numTests)
+        stop("Indices of family %i must be a partition of its p-values!", f + 1);
+    }
+    // a single-step scan evaluates each CDF at each p-value
+    if(single_step) cost[f] = std::min<double>(cost[f] + numTests, (double)numCDF * numTests);
+    else cost[f] += numTests;
+  }
+
+  //--------------------------------------------
+  //        analyse the families in parallel,
+  //        the most expensive ones first
+  //--------------------------------------------
+  std::vector<int> order(numFamilies);
+  for(int f = 0; f < numFamilies; f++) order[f] = f;
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {return cost[a] > cost[b];});
+
+  std::vector<NumericVector> adjusted(numFamilies);
+  for(int f = 0; f < numFamilies; f++) adjusted[f] = NumericVector(pvalues[f].length());
+  std::vector<double*> adjusted_ptr(numFamilies);
+  for(int f = 0; f < numFamilies; f++) adjusted_ptr[f] = adjusted[f].begin();
+
+  int threads = std::max<int>(1, std::min<int>(num_threads, numFamilies));
+  // reusable buffers of each thread
+  std::vector<adjust_workspace> workspaces(threads);
+  // families are assigned one at a time to the next idle thread, so that
+  // large families do not hold up the small ones; each family is analysed by
+  // a single thread, so no R API may be used within the loop
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+#endif
+  for(int k = 0; k < numFamilies; k++) {
+    int f = order[k];
+#ifdef _OPENMP
+    adjust_workspace &ws = workspaces[omp_get_thread_num()];
+#else
+    adjust_workspace &ws = workspaces[0];
+#endif
+    adjust_pvalues(fams[f], pvalues[f].begin(), pvalues[f].length(), independence, single_step, 1, adjusted_ptr[f], ws);
+  }
+
+  //--------------------------------------------
+  //        number of rejections of each family
+  //        and FWER level
+  //--------------------------------------------
+  List adjusted_out(numFamilies);
+  IntegerMatrix num_rejected(numFamilies, numAlpha);
+  for(int f = 0; f < numFamilies; f++) {
+    adjusted_out[f] = adjusted[f];
+    for(int a = 0; a < numAlpha; a++) {
+      int m_rej = 0;
+      for(int j = 0; j < adjusted[f].length(); j++) if(adjusted[f][j] <= alpha[a]) m_rej++;
+      num_rejected(f, a) = m_rej;
+    }
+  }
+
+  return List::create(
+    Named("Adjusted") = adjusted_out,
+    Named("Num_rejected") = num_rejected
+  );
+}
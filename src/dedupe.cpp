@@ -0,0 +1,53 @@
+#include "kernel.h"
+#include <unordered_map>
+
+// FNV-1a hash of the values of a CDF (including its length)
+static uint64_t hash_CDF(const double* vals, const int len) {
+  uint64_t hash = 14695981039346656037ULL;
+  const unsigned char* bytes = (const unsigned char*)vals;
+  for(size_t k = 0; k < (size_t)len * sizeof(double); k++) {
+    hash ^= bytes[k];
+    hash *= 1099511628211ULL;
+  }
+  return (hash ^ (uint64_t)len) * 1099511628211ULL;
+}
+
+List deduplicate_CDFs_int(const List& pCDFlist) {
+  int numCDF = pCDFlist.length();
+  std::vector<NumericVector> sfuns(numCDF);
+  for(int i = 0; i < numCDF; i++) sfuns[i] = as<NumericVector>(pCDFlist[i]);
+  
+  // unique CDFs (by position) and the positions of their duplicates; CDFs
+  // with equal hashes are compared value by value
+  std::unordered_map<uint64_t, std::vector<int> > buckets;
+  buckets.reserve(numCDF);
+  std::vector<int> first;
+  std::vector<std::vector<int> > groups;
+  for(int i = 0; i < numCDF; i++) {
+    int len = sfuns[i].length();
+    std::vector<int> &bucket = buckets[hash_CDF(sfuns[i].begin(), len)];
+    int g = -1;
+    for(size_t b = 0; b < bucket.size() && g < 0; b++) {
+      const NumericVector &other = sfuns[first[bucket[b]]];
+      if(other.length() == len && std::equal(other.begin(), other.end(), sfuns[i].begin()))
+        g = bucket[b];
+    }
+    if(g < 0) {
+      g = (int)first.size();
+      first.push_back(i);
+      groups.push_back(std::vector<int>());
+      bucket.push_back(g);
+    }
+    groups[g].push_back(i + 1);
+  }
+  
+  int numUnique = (int)first.size();
+  IntegerVector unique(numUnique);
+  List indices(numUnique);
+  for(int g = 0; g < numUnique; g++) {
+    unique[g] = first[g] + 1;
+    indices[g] = IntegerVector(groups[g].begin(), groups[g].end());
+  }
+  
+  return List::create(Named("unique") = unique, Named("indices") = indices);
+}
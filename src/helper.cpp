@@ -11,18 +11,12 @@ IntegerVector order(const NumericVector &x, bool descending) {
     return ord;
 }*/
 
-// function that binds two vectors, sorts it and eliminates duplications 
+// function that merges two sorted vectors and eliminates duplications (in
+// linear time, see 'merge_unique')
 NumericVector sort_combine(const NumericVector &x, const NumericVector &y){
-  // vector lengths
-  int lenA = x.length(), lenB = y.length();
   // output vector of the combined lengths of 'x' and 'y'
-  NumericVector out(lenA + lenB);
+  std::vector<double> out(x.length() + y.length());
+  int len = merge_unique(x.begin(), x.length(), y.begin(), y.length(), out.data());
   
-  // bind vectors 'x' and 'y'
-  for(int i = 0; i < lenA; i++) out[i] = x[i];
-  for(int i = 0; i < lenB; i++) out[lenA + i] = y[i];
-  // sort and eliminate duplicates
-  out = sort_unique(out);
-  
-  return out;
+  return NumericVector(out.begin(), out.begin() + len);
 }
\ No newline at end of file
@@ -1,53 +1,90 @@
 #include <Rcpp.h>
+#include <DiscreteFWER/procedures.h>
+#include <DiscreteFWER/shard.h>
+#include <DiscreteFWER/incremental.h>
+#include "store.h"
+#include <memory>
 using namespace Rcpp;
+using namespace DiscreteFWER;
 
-inline double eval_pv(double val, const NumericVector& vec, int len, int& pos){
-  //if(val < 1){
-    while(pos < len && vec[pos] <= 1 && vec[pos] <= val) pos++;
-    if(pos) return vec[pos - 1];
-    else return 0;
-  //} else eval = 1;
-}
-
-/*inline double eval_pv_rev(double &eval, double val, const NumericVector &vec, int &pos){
-  //if(val < 1){
-  while(pos > 0 && (vec[pos] > val || vec[pos] > 1)) pos--;
-  if(vec[pos] <= val) return vec[pos];
-  else return 0;
-  //} else eval = 1;
-}*/
-
-// computes the index of the largest element of a vector which is <= a given value
-inline int binary_search(const NumericVector &vec, const double value, const int len) {
-  int idx_left = 0, idx_right = len - 1, idx_mid = len - 1;
-  bool stop = false;
+// p-value CDFs that are given either by a list, by a prepared family, i.e.
+// an external pointer created by 'prepare_family_int', or by the file name of
+// a CDF store; the vectors of a list are kept, so that their values can be
+// used safely; optional scale factors rescale the CDFs (e.g. after selection)
+// without copying them
+class CDF_source {
+public:
+  CDF_source(const SEXP pCDFlist, const Nullable<NumericVector> &pCDFscales = R_NilValue) : prepared(NULL), own_prepared(NULL) {
+    if(TYPEOF(pCDFlist) == EXTPTRSXP) {
+      own_prepared = XPtr<prepared_family>(pCDFlist).get();
+      if(own_prepared == NULL) stop("Prepared family of p-value CDFs is invalid!");
+    } else if(TYPEOF(pCDFlist) == STRSXP) {
+      store.reset(new CDF_store(as<std::string>(pCDFlist)));
+    } else {
+      List list(pCDFlist);
+      sfuns.resize(list.length());
+      for(int i = 0; i < (int)sfuns.size(); i++) sfuns[i] = as<NumericVector>(list[i]);
+    }
+    if(pCDFscales.isNotNull()) {
+      scales = NumericVector(pCDFscales);
+      if(scales.length() != size()) stop("Number of scale factors must equal the number of CDFs!");
+    }
+    // support, ranks and caches of a prepared family only apply to the
+    // CDFs as they are
+    if(!scaled()) prepared = own_prepared;
+  }
+  
+  // number of unique CDFs
+  inline int size() const {
+    if(own_prepared) return own_prepared->view.numCDF;
+    if(store) return store->numCDF();
+    return (int)sfuns.size();
+  }
   
-  while(!stop) {
-    if(vec[idx_mid] > value) {
-      if(idx_mid == 0) {
-        stop = true;
-      } else if(idx_mid - idx_left == 1) {
-        stop = true;
-        idx_mid = idx_left;
-      } else {
-        idx_right = idx_mid;
-        idx_mid = idx_left + (idx_right - idx_left) / 2;
-      }
-    } else if(vec[idx_mid] <= value) {
-      if(vec[idx_mid] == value || idx_mid == len - 1 || idx_right - idx_mid == 1) {
-        stop = true;
-      } else {
-        idx_left = idx_mid;
-        idx_mid = idx_left + (idx_right - idx_left + 1) / 2;
-      }
+  // whether the CDFs are rescaled
+  inline bool scaled() const { return scales.length() > 0; }
+  
+  // R-independent view of the (rescaled) CDFs (without counts and indices)
+  inline CDF_family family() const {
+    CDF_family fam(size());
+    if(own_prepared) fam = own_prepared->view;
+    else if(store) fam = store->family();
+    else for(int i = 0; i < fam.numCDF; i++) {
+      fam.vals[i] = sfuns[i].begin();
+      fam.lens[i] = CDF_length(sfuns[i].begin(), sfuns[i].length());
     }
+    if(scaled()) scale_family(fam, scales.begin());
+    return fam;
+  }
+  
+  // releases the memory of the CDFs 'from', ..., 'to - 1' of a store after
+  // they have been processed (no-op for lists and prepared families)
+  inline void release(const int from, const int to) const {
+    if(store) store->release(from, to);
   }
   
-  return idx_mid;
-}
+  // prepared family, if its support, ranks and caches apply to 'support',
+  // i.e. if it is exactly its overall support (or NULL)
+  inline prepared_family* prepared_for(const NumericVector &support) const {
+    if(prepared == NULL || prepared->support.size() != (size_t)support.length() ||
+       !std::equal(support.begin(), support.end(), prepared->support.begin()))
+      return NULL;
+    return prepared;
+  }
+  
+  // prepared family (or NULL, if the CDFs are not given by one or if they
+  // are rescaled)
+  prepared_family* prepared;
+  
+private:
+  prepared_family* own_prepared;
+  std::vector<NumericVector> sfuns;
+  std::unique_ptr<CDF_store> store;
+  NumericVector scales;
+};
 
 // sort order
 //IntegerVector order(const NumericVector &x, bool descending = false);
 
-// function that binds two vectors, sorts it and eliminates duplications 
+// function that merges two sorted vectors and eliminates duplications
 NumericVector sort_combine(const NumericVector &x, const NumericVector &y);
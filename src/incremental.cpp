@@ -0,0 +1,95 @@
+#include "kernel.h"
+
+SEXP incremental_create_int(const bool independence, const bool single_step) {
+  XPtr<incremental_family> family(new incremental_family(independence, single_step), true);
+
+  return family;
+}
+
+bool incremental_valid(const SEXP family) {
+  return TYPEOF(family) == EXTPTRSXP && XPtr<incremental_family>(family).get() != NULL;
+}
+
+void incremental_append_int(
+  const SEXP family,
+  const List& pCDFlist,
+  const NumericVector& pvalues,
+  const Nullable<List>& pCDFindices,
+  const int num_threads
+) {
+  if(!incremental_valid(family)) stop("Incremental analysis is invalid!");
+  incremental_family* state = XPtr<incremental_family>(family).get();
+
+  // new p-value CDFs and the (1-based) indices of their new p-values
+  CDF_source source(pCDFlist);
+  CDF_family fam = source.family();
+  List indices = pCDFindices.isNotNull() ? as<List>(pCDFindices) : List(0);
+  std::vector<IntegerVector> idx(indices.length());
+  for(int i = 0; i < (int)idx.size(); i++) {
+    idx[i] = as<IntegerVector>(indices[i]);
+    fam.counts[i] = idx[i].length();
+    fam.indices[i] = idx[i].begin();
+  }
+
+  state->append(fam, pvalues.begin(), pvalues.length(), num_threads);
+}
+
+List incremental_results_int(const SEXP family, const NumericVector& alpha, const bool crit_consts) {
+  if(!incremental_valid(family)) stop("Incremental analysis is invalid!");
+  const incremental_family* state = XPtr<incremental_family>(family).get();
+  if(crit_consts && !state->single_step)
+    stop("Incremental critical values are only available for single-step procedures!");
+
+  int numTests = state->numTests();
+  int numAlpha = alpha.length();
+
+  // adjusted p-values (sorted and in the original order) and critical values
+  std::vector<double> pv_adj(numTests);
+  state->adjusted_sorted(pv_adj.data());
+  NumericVector adjusted(numTests);
+  for(int j = 0; j < numTests; j++) adjusted[state->order[j]] = pv_adj[j];
+  SEXP crit = R_NilValue;
+  NumericVector crit_vals(crit_consts ? numAlpha : 0);
+  if(crit_consts) {
+    state->critical(alpha.begin(), numAlpha, crit_vals.begin());
+    crit = crit_vals;
+  }
+
+  //--------------------------------------------
+  //        number of rejections and (1-based)
+  //        indices of the rejected p-values for
+  //        each FWER level (like in
+  //        'discrete_fwer_native')
+  //--------------------------------------------
+  IntegerVector num_rejected(numAlpha);
+  List rejected(numAlpha);
+  bool step_up = state->single_step || state->independence;
+  const std::vector<double> &sorted_pv = state->sorted_pv;
+  for(int a = 0; a < numAlpha; a++) {
+    auto reject = [&](int j) {
+      double value = crit_consts ? sorted_pv[j] : pv_adj[j];
+      double bound = crit_consts ? crit_vals[a] : alpha[a];
+      return step_up ? value <= bound : value > bound;
+    };
+    int m_rej = step_up ? 0 : numTests;
+    if(step_up) {
+      for(int j = numTests - 1; j >= 0 && !m_rej; j--) if(reject(j)) m_rej = j + 1;
+    } else {
+      for(int j = 0; j < numTests; j++) if(reject(j)) {m_rej = j; break;}
+    }
+    num_rejected[a] = m_rej;
+    std::vector<int> idx_rej;
+    if(m_rej > 0) {
+      double largest = sorted_pv[m_rej - 1];
+      for(int i = 0; i < numTests; i++) if(state->pvalues[i] <= largest) idx_rej.push_back(i + 1);
+    }
+    rejected[a] = wrap(idx_rej);
+  }
+
+  return List::create(
+    Named("Adjusted") = adjusted,
+    Named("Critical_values") = crit,
+    Named("Num_rejected") = num_rejected,
+    Named("Indices") = rejected
+  );
+}
@@ -0,0 +1,274 @@
+#include "kernel.h"
+
+List discrete_fwer_native(
+  const SEXP pCDFlist,
+  const NumericVector& pvalues,
+  const Nullable<List>& pCDFindices,
+  const NumericVector& alpha,
+  const bool independence,
+  const bool single_step,
+  const bool crit_consts,
+  const int num_threads,
+  const Nullable<NumericVector>& pCDFscales,
+  const bool profile,
+  const std::string& engine
+) {
+  if(engine != "auto" && engine != "scan" && engine != "breakpoints" && engine != "pruned" && engine != "full" && engine != "approx" && engine != "rejections")
+    stop("Unknown engine '" + engine + "'!");
+  if(crit_consts ? engine == "scan" || engine == "breakpoints" || engine == "rejections" || (engine == "approx" && !single_step) : engine == "pruned" || engine == "full")
+    stop("Engine '" + engine + "' is not available for the requested computations!");
+  
+  // timings and counters of the phases (only recorded, if requested)
+  phase_timer timer;
+  kernel_profile kprof;
+  kernel_profile* prof = profile ? &kprof : NULL;
+  double seconds_support = 0;
+  
+  // number of (selected) p-values
+  int numTests = pvalues.length();
+  // number of FWER levels
+  int numAlpha = alpha.length();
+  // (rescaled) p-value CDFs; only their lengths are needed here, which a
+  // store takes from its offsets, so that its values are only read (and
+  // released) by the kernels
+  CDF_source source(pCDFlist, pCDFscales);
+  int numCDF = source.size();
+  CDF_family family = source.family();
+  
+  // sort order of the p-values (ties keep their order, like R's 'order()')
+  // and the (1-based) position of each p-value in the sorted vector
+  std::vector<int> ord(numTests), org_ord(numTests);
+  for(int i = 0; i < numTests; i++) ord[i] = i;
+  std::stable_sort(ord.begin(), ord.end(), [&](int a, int b) {return pvalues[a] < pvalues[b];});
+  NumericVector sorted_pv(numTests);
+  for(int j = 0; j < numTests; j++) {
+    sorted_pv[j] = pvalues[ord[j]];
+    org_ord[ord[j]] = j + 1;
+  }
+  
+  // counts of the CDFs and sorted indices of the sorted p-values to which
+  // they belong (without indices, the i-th CDF belongs to the i-th p-value)
+  IntegerVector CDFcounts(numCDF);
+  List sorted_indices(numCDF);
+  bool has_indices = pCDFindices.isNotNull() && as<List>(pCDFindices).length() > 0;
+  List indices = has_indices ? as<List>(pCDFindices) : List(0);
+  // the indices must be a partition of the p-values (e.g. those of a CDF store
+  // are only checked here)
+  if(has_indices ? indices.length() != numCDF : numCDF != numTests)
+    stop("The number of p-values and the number of CDFs or indices do not match!");
+  std::vector<bool> seen(has_indices ? numTests : 0, false);
+  int numSeen = 0;
+  for(int i = 0; i < numCDF; i++) {
+    IntegerVector idx;
+    if(has_indices) {
+      IntegerVector orig = as<IntegerVector>(indices[i]);
+      if(!orig.length()) stop("CDF %i belongs to no p-value!", i + 1);
+      idx = IntegerVector(orig.length());
+      for(int k = 0; k < orig.length(); k++) {
+        if(orig[k] < 1 || orig[k] > numTests || seen[orig[k] - 1])
+          stop("The indices of the CDFs must be a partition of the p-values!");
+        seen[orig[k] - 1] = true;
+        numSeen++;
+        idx[k] = org_ord[orig[k] - 1];
+      }
+      std::sort(idx.begin(), idx.end());
+    } else idx = IntegerVector(1, (double)org_ord[i]);
+    CDFcounts[i] = idx.length();
+    sorted_indices[i] = idx;
+  }
+  if(has_indices && numSeen != numTests)
+    stop("The indices of the CDFs must be a partition of the p-values!");
+  
+  // statistics for choosing the evaluation strategy
+  family_stats stats;
+  stats.num_cdfs = numCDF;
+  stats.num_tests = numTests;
+  for(int i = 0; i < numCDF; i++) {
+    stats.num_values += family.lens[i];
+    // a stepwise scan evaluates a CDF up to its last p-value
+    stats.scan_points += single_step ? numTests : as<IntegerVector>(sorted_indices[i])[CDFcounts[i] - 1];
+  }
+  for(int j = 0; j < numTests; j++)
+    if(!j || sorted_pv[j] != sorted_pv[j - 1]) stats.num_distinct++;
+  double seconds_preprocessing = timer.lap();
+  
+  //--------------------------------------------
+  //        compute adjusted p-values and (if
+  //        requested) critical values of all
+  //        FWER levels in a single pass
+  //--------------------------------------------
+  NumericVector pv_adj;
+  SEXP crit = R_NilValue;
+  kernel_plan plan;
+  // results of the approximation (only for engine "approx")
+  List approx;
+  // numbers of rejections (only for engine "rejections")
+  IntegerVector early_rejected;
+  if(crit_consts) {
+    // overall support (already available for prepared families)
+    NumericVector support;
+    if(source.prepared)
+      support = NumericVector(source.prepared->support.begin(), source.prepared->support.end());
+    else {
+      std::vector<double> merged = merge_support(family);
+      support = NumericVector(merged.begin(), merged.end());
+    }
+    seconds_support = timer.lap();
+    // support values that are needed after pruning (like in the kernels)
+    double limit = *std::max_element(alpha.begin(), alpha.end());
+    if(numTests) limit = std::max<double>(limit, sorted_pv[numTests - 1]);
+    stats.support_size = support.length();
+    stats.active_support = active_support(support.begin(), support.length(), limit);
+    plan = choose_plan(stats, true, single_step, num_threads, engine);
+    List res = plan.approximate ?
+      kernel_DFWER_approx(pCDFlist, support, sorted_pv, alpha, independence, true, true, sorted_indices, plan.num_threads, pCDFscales, prof) : single_step ?
+      kernel_DFWER_singlestep_crit(pCDFlist, support, sorted_pv, alpha, independence, CDFcounts, plan.num_threads, pCDFscales, plan.pruned, prof) :
+      kernel_DFWER_stepwise_crit(pCDFlist, support, sorted_pv, alpha, independence, sorted_indices, pCDFscales, plan.pruned, prof);
+    crit = res["crit_consts"];
+    pv_adj = res["pval_transf"];
+    if(plan.approximate) approx = res;
+  } else {
+    // scan of the p-values or accumulation of the CDFs at their breakpoints,
+    // whichever is cheaper (e.g. the latter for many unique CDFs)
+    plan = choose_plan(stats, false, single_step, num_threads, engine);
+    if(plan.approximate) {
+      // bounds that are evaluated exactly only where they do not determine
+      // the rejections
+      approx = kernel_DFWER_approx(pCDFlist, NumericVector(0), sorted_pv, alpha, independence, single_step, false, sorted_indices, plan.num_threads, pCDFscales, prof);
+      pv_adj = approx["pval_transf"];
+    } else if(plan.rejections_only) {
+      // only the p-values that determine the rejections (or all of them, if
+      // stopping early would cost more than their complete evaluation)
+      List res = kernel_DFWER_rejections(pCDFlist, sorted_pv, alpha, independence, single_step, sorted_indices, plan.breakpoints, plan.cost, plan.num_threads, pCDFscales, prof);
+      pv_adj = res["pval_transf"];
+      early_rejected = res["num_rejected"];
+    } else pv_adj = single_step ?
+      kernel_DFWER_singlestep_fast(pCDFlist, sorted_pv, independence, CDFcounts, plan.breakpoints, plan.num_threads, pCDFscales, prof) :
+      kernel_DFWER_stepwise_fast(pCDFlist, sorted_pv, independence, sorted_indices, plan.breakpoints, plan.num_threads, pCDFscales, prof);
+  }
+  
+  // the kernel's own time is split into evaluation and search
+  double seconds_kernel = timer.lap();
+  
+  // adjusted p-values in the original order
+  NumericVector adjusted(numTests);
+  for(int i = 0; i < numTests; i++) adjusted[i] = pv_adj[org_ord[i] - 1];
+  
+  //--------------------------------------------
+  //        number of rejections and (1-based)
+  //        indices of the rejected p-values for
+  //        each FWER level
+  //--------------------------------------------
+  IntegerVector num_rejected(numAlpha);
+  List rejected(numAlpha);
+  bool step_up = single_step || independence;
+  NumericVector crit_vals = crit_consts ? NumericVector(crit) : NumericVector(0);
+  for(int a = 0; a < numAlpha; a++) {
+    // whether the j-th sorted p-value satisfies the rejection criterion
+    auto reject = [&](int j) {
+      double bound = alpha[a], value = pv_adj[j];
+      if(crit_consts) {
+        value = sorted_pv[j];
+        bound = single_step ? crit_vals[a] : crit_vals[j + a * numTests];
+      }
+      return step_up ? value <= bound : value > bound;
+    };
+    // number of rejections (already determined by engine "rejections", as
+    // not all adjusted p-values are available)
+    int m_rej = step_up ? 0 : numTests;
+    if(plan.rejections_only) {
+      m_rej = early_rejected[a];
+    } else if(step_up) {
+      for(int j = numTests - 1; j >= 0 && !m_rej; j--) if(reject(j)) m_rej = j + 1;
+    } else {
+      for(int j = 0; j < numTests; j++) if(reject(j)) {m_rej = j; break;}
+    }
+    num_rejected[a] = m_rej;
+    // rejected p-values are those not greater than the largest rejected one
+    int k = 0;
+    if(m_rej > 0) {
+      double largest = sorted_pv[m_rej - 1];
+      for(int i = 0; i < numTests; i++) if(pvalues[i] <= largest) k++;
+    }
+    IntegerVector idx_rej(k);
+    if(m_rej > 0) {
+      double largest = sorted_pv[m_rej - 1];
+      for(int i = 0, l = 0; i < numTests; i++) if(pvalues[i] <= largest) idx_rej[l++] = i + 1;
+    }
+    rejected[a] = idx_rej;
+  }
+  
+  // profile of the native phases
+  SEXP prof_out = R_NilValue;
+  if(profile) {
+    double seconds_rejections = timer.lap();
+    // overhead of the kernels (e.g. conversions) counts as evaluation
+    double seconds_eval = seconds_kernel - kprof.seconds_search;
+    NumericVector seconds = NumericVector::create(
+      Named("preprocessing") = seconds_preprocessing,
+      Named("support") = seconds_support,
+      Named("evaluation") = seconds_eval,
+      Named("search") = kprof.seconds_search,
+      Named("rejections") = seconds_rejections
+    );
+    // bytes of the sorted p-values and indices, the support and the results
+    double bytes_preprocessing = (double)numTests * (sizeof(double) + 3 * sizeof(int));
+    NumericVector bytes = NumericVector::create(
+      Named("preprocessing") = bytes_preprocessing,
+      Named("support") = (double)kprof.support_size * sizeof(double),
+      Named("evaluation") = kprof.working_bytes,
+      Named("rejections") = (double)numTests * (sizeof(double) + numAlpha * sizeof(int))
+    );
+    NumericVector counters = NumericVector::create(
+      Named("cdf_evaluations") = kprof.cdf_evaluations,
+      Named("support_size") = kprof.support_size,
+      Named("active_support") = kprof.active_support,
+      Named("tie_blocks") = kprof.tie_blocks
+    );
+    prof_out = List::create(Named("Seconds") = seconds, Named("Bytes") = bytes, Named("Counters") = counters);
+  }
+  
+  // chosen evaluation strategy and the statistics it is based on
+  std::string strategy = plan.approximate ? "approx" : plan.rejections_only ? "rejections" : crit_consts ? (plan.pruned ? "pruned" : "full") : (plan.breakpoints ? "breakpoints" : "scan");
+  List plan_out = List::create(
+    Named("Engine") = strategy,
+    Named("Automatic") = engine == "auto",
+    Named("Threads") = plan.num_threads,
+    Named("Cost") = plan.cost,
+    Named("Statistics") = NumericVector::create(
+      Named("unique_CDFs") = stats.num_cdfs,
+      Named("CDF_values") = stats.num_values,
+      Named("tests") = stats.num_tests,
+      Named("distinct_pvalues") = stats.num_distinct,
+      Named("support_size") = stats.support_size,
+      Named("active_support") = stats.active_support
+    )
+  );
+  
+  // certified errors of the approximate adjusted p-values (in the original
+  // order), their maximum and the number of exactly evaluated points
+  SEXP approx_out = R_NilValue;
+  if(plan.approximate) {
+    NumericVector errors_sorted = approx["errors"], errors(numTests);
+    double max_error = 0;
+    for(int i = 0; i < numTests; i++) {
+      errors[i] = errors_sorted[org_ord[i] - 1];
+      max_error = std::max<double>(max_error, errors[i]);
+    }
+    approx_out = List::create(
+      Named("Errors") = errors,
+      Named("Max_error") = max_error,
+      Named("Exact_points") = approx["exact"]
+    );
+  }
+  
+  return List::create(
+    Named("Adjusted") = adjusted,
+    Named("Critical_values") = crit,
+    Named("Num_rejected") = num_rejected,
+    Named("Indices") = rejected,
+    Named("Profile") = prof_out,
+    Named("Plan") = plan_out,
+    Named("Approximation") = approx_out
+  );
+}
@@ -1,15 +1,76 @@
 #include "kernel.h"
 
+// buffers of the kernels for critical values; the kernels only run on R's main
+// thread (and one at a time), so a single workspace is shared by all calls and
+// keeps its memory between them
+static critical_workspace kernel_workspace;
+
+// exported kernels (without profiling)
 NumericVector kernel_DFWER_singlestep_fast(
-  const List& pCDFlist,
+  const SEXP pCDFlist,
   const NumericVector& pvalues,
   const bool independence,
-  const Nullable<IntegerVector>& pCDFcounts
+  const Nullable<IntegerVector>& pCDFcounts,
+  const bool breakpoints,
+  const int num_threads,
+  const Nullable<NumericVector>& pCDFscales
+) {
+  return kernel_DFWER_singlestep_fast(pCDFlist, pvalues, independence, pCDFcounts, breakpoints, num_threads, pCDFscales, NULL);
+}
+
+List kernel_DFWER_singlestep_crit(
+  const SEXP pCDFlist,
+  const NumericVector& support,
+  const NumericVector& sorted_pv,
+  const NumericVector& alpha,
+  const bool independence,
+  const Nullable<IntegerVector>& pCDFcounts,
+  const int num_threads,
+  const Nullable<NumericVector>& pCDFscales
+) {
+  return kernel_DFWER_singlestep_crit(pCDFlist, support, sorted_pv, alpha, independence, pCDFcounts, num_threads, pCDFscales, true, NULL);
+}
+
+NumericVector kernel_DFWER_stepwise_fast(
+  const SEXP pCDFlist,
+  const NumericVector& sorted_pv,
+  const bool independence,
+  const Nullable<List>& pCDFindices,
+  const bool breakpoints,
+  const int num_threads,
+  const Nullable<NumericVector>& pCDFscales
+) {
+  return kernel_DFWER_stepwise_fast(pCDFlist, sorted_pv, independence, pCDFindices, breakpoints, num_threads, pCDFscales, NULL);
+}
+
+List kernel_DFWER_stepwise_crit(
+  const SEXP pCDFlist,
+  const NumericVector& support,
+  const NumericVector& sorted_pv,
+  const NumericVector& alpha,
+  const bool independence,
+  const Nullable<List>& pCDFindices,
+  const Nullable<NumericVector>& pCDFscales
+) {
+  return kernel_DFWER_stepwise_crit(pCDFlist, support, sorted_pv, alpha, independence, pCDFindices, pCDFscales, true, NULL);
+}
+
+NumericVector kernel_DFWER_singlestep_fast(
+  const SEXP pCDFlist,
+  const NumericVector& pvalues,
+  const bool independence,
+  const Nullable<IntegerVector>& pCDFcounts,
+  const bool breakpoints,
+  const int num_threads,
+  const Nullable<NumericVector>& pCDFscales,
+  kernel_profile* profile
 ) {
   // Number of p-values
   int numValues = pvalues.length();
+  // p-value CDFs
+  CDF_source source(pCDFlist, pCDFscales);
   // number of unique p-value distributions
-  int numCDF = pCDFlist.length();
+  int numCDF = source.size();
   // counts of the CDFs
   IntegerVector CDFcounts;
   if(numCDF == numValues || pCDFcounts.isNull() || as<IntegerVector>(pCDFcounts).length() == 0) 
@@ -17,61 +78,51 @@ NumericVector kernel_DFWER_singlestep_fast(
   else 
     CDFcounts = pCDFcounts;
   
-  // extract p-value CDF vectors
-  NumericVector* sfuns = new NumericVector[(unsigned int)numCDF];
-  for(int i = 0; i < numCDF; i++) sfuns[i] = as<NumericVector>(pCDFlist[i]);
+  // R-independent view of the CDFs for the computations
+  CDF_family family = source.family();
+  for(int i = 0; i < numCDF; i++) family.counts[i] = CDFcounts[i];
   
   // vector to store transformed p-values
   NumericVector pval_transf(numValues);
-  // evaluation of current p-value CDF
-  NumericVector f_eval(numValues);
-  for(int i = 0; i < numCDF; i++) {
+  phase_timer timer;
+  // user interrupts can only be checked in between blocks of CDFs
+  singlestep_adjust(family, pvalues.begin(), numValues, independence, breakpoints, num_threads, pval_transf.begin(), [&](int from, int to) {
+    source.release(from, to);
     checkUserInterrupt();
-    
-    int pos = 0;
-    int len = sfuns[i].length();
-    for(int j = 0; j < numValues; j++) {
-      f_eval[j] = eval_pv(pvalues[j], sfuns[i], len, pos);
-    }
-    
-    if(independence)
-      pval_transf += (double)CDFcounts[i] * log(1 - f_eval);
-    else 
-      pval_transf += (double)CDFcounts[i] * f_eval;
+  });
+  
+  if(profile) {
+    profile->seconds_eval += timer.lap();
+    double numCDFvalues = 0;
+    for(int i = 0; i < numCDF; i++) numCDFvalues += family.lens[i];
+    profile->cdf_evaluations += breakpoints ? numCDFvalues : (double)numCDF * numValues;
+    profile->working_bytes += (double)numValues * sizeof(double);
   }
   
-  if(independence)
-    pval_transf = 1 - exp(pval_transf);
-  
-  // garbage collection
-  delete[] sfuns;
-  
-  // compute adjustments
-  for(int i = 0; i < numValues; i++)
-    if(pval_transf[i] > 1.0) pval_transf[i] = 1.0;
-  
   return pval_transf;
 }
 
 List kernel_DFWER_singlestep_crit(
-  const List& pCDFlist,
+  const SEXP pCDFlist,
   const NumericVector& support,
   const NumericVector& sorted_pv,
-  const double alpha,
+  const NumericVector& alpha,
   const bool independence,
-  const Nullable<IntegerVector>& pCDFcounts
+  const Nullable<IntegerVector>& pCDFcounts,
+  const int num_threads,
+  const Nullable<NumericVector>& pCDFscales,
+  const bool prune,
+  kernel_profile* profile
 ) {
   // number of tests
   int numTests = sorted_pv.length();
+  // p-value CDFs
+  CDF_source source(pCDFlist, pCDFscales);
   // number of unique p-value distributions
-  int numCDF = pCDFlist.length();
+  int numCDF = source.size();
   // number of all attainable p-values in the support
   int numValues = support.length();
   
-  // extract p-value CDF vectors
-  NumericVector* sfuns = new NumericVector[(unsigned int)numCDF];
-  for(int i = 0; i < numCDF; i++) sfuns[i] = as<NumericVector>(pCDFlist[i]);
-  
   // get count of each unique p-value distribution
   IntegerVector CDFcounts;
   if(pCDFcounts.isNull() || as<IntegerVector>(pCDFcounts).length() == 0)
@@ -79,343 +130,298 @@ List kernel_DFWER_singlestep_crit(
   else
     CDFcounts = pCDFcounts;
   
-  // restrict support to values <= alpha (critical value cannot exceed alpha)
-  int idx_max = binary_search(support, alpha, numValues);
-  //NumericVector pv_list = support[Range(0, index_max)];
-  
-  // transform support with fast kernel
-  NumericVector support_transf = kernel_DFWER_singlestep_fast(
-    pCDFlist, support, independence, CDFcounts
-  );
-  
-  // get index of critical value
-  int idx_pval = binary_search(support_transf, alpha, idx_max + 1);
-  // vector to store critical value
-  NumericVector crit(1, support[idx_pval]);
-  
-  // store transformed sorted pvalues
-  NumericVector pval_transf(numTests);
-  // search for sorted p-values in 'pv_list' and save their adjustments
-  idx_pval = 0;
-  for(int i = 0; i < numTests; i++) {
-    checkUserInterrupt();
-    while(idx_pval < numValues && support[idx_pval] < sorted_pv[i]) idx_pval++;
-    pval_transf[i] = std::min<double>(1.0, support_transf[idx_pval]);
+  // only support values up to the largest FWER level or observed p-value
+  // (and the next larger one) are needed, so the CDFs are truncated there
+  // (unless pruning is switched off)
+  double limit = *std::max_element(alpha.begin(), alpha.end());
+  if(numTests) limit = std::max<double>(limit, sorted_pv[numTests - 1]);
+  int numActive = prune ? active_support(support.begin(), numValues, limit) : numValues;
+  
+  // R-independent view of the CDFs for the computations
+  phase_timer timer;
+  CDF_family family = source.family();
+  for(int i = 0; i < numCDF; i++) family.counts[i] = CDFcounts[i];
+  // prepared family, if its support is the given one
+  prepared_family* prepared = source.prepared_for(support);
+  // rank encoding of the truncated CDFs (prepared families already have the
+  // one of the complete CDFs, whose runs end at the active support anyway)
+  critical_workspace &ws = kernel_workspace;
+  if(prepared == NULL)
+    ws.ranks.assign(truncate_family(family, support[numActive - 1]), support.begin(), numActive);
+  const CDF_ranks &ranks = prepared ? prepared->ranks : ws.ranks;
+  
+  // transform active support (or take it from the cache of the prepared
+  // family)
+  ws.sums.resize(numActive);
+  double* sums = ws.sums.data();
+  const double* cached = prepared ? prepared->cached_transf(independence, family.counts, numActive) : NULL;
+  if(cached != NULL) {
+    std::copy(cached, cached + numActive, sums);
+  } else {
+    // user interrupts can only be checked in between blocks of CDFs
+    singlestep_support_sums(ranks, family, support.begin(), numActive, independence, num_threads, sums, [](int, int) {
+      checkUserInterrupt();
+    });
+    if(prepared) prepared->cache_transf(independence, family.counts, sums, numActive);
+  }
+  if(profile) {
+    profile->seconds_eval += timer.lap();
+    profile->support_size = numValues;
+    profile->active_support = numActive;
+    if(cached == NULL) profile->cdf_evaluations += (double)numCDF * numActive;
+    profile->working_bytes += ws.bytes() + (double)numTests * sizeof(double);
   }
   
-  // garbage collection
-  delete[] sfuns;
+  // critical value of each FWER level and transformed sorted p-values
+  NumericVector crit(alpha.length());
+  NumericVector pval_transf(numTests);
+  singlestep_critical(support.begin(), numValues, sums, numActive, alpha.begin(), alpha.length(), sorted_pv.begin(), numTests, crit.begin(), pval_transf.begin());
+  if(profile) profile->seconds_search += timer.lap();
   
   // return critical values and adjusted sorted p-values
   return List::create(Named("crit_consts") = crit, Named("pval_transf") = pval_transf);
 }
 
 NumericVector kernel_DFWER_stepwise_fast(
-  const List& pCDFlist,
+  const SEXP pCDFlist,
   const NumericVector& sorted_pv,
   const bool independence,
-  const Nullable<List>& pCDFindices
+  const Nullable<List>& pCDFindices,
+  const bool breakpoints,
+  const int num_threads,
+  const Nullable<NumericVector>& pCDFscales,
+  kernel_profile* profile
 ) {
   // number of tests
   int numTests = sorted_pv.length();
+  // p-value CDFs
+  CDF_source source(pCDFlist, pCDFscales);
   // number of unique p-value distributions
-  int numCDF = pCDFlist.length();
-  // indices of the CDFs and their counts
-  IntegerVector* CDFindices = new IntegerVector[numCDF];
-  int* CDFcounts = new int[numCDF];
-  if(pCDFindices.isNull() || as<List>(pCDFindices).length() == 0) {
-    for(int i = 0; i < numCDF; i++) {
-      CDFindices[i] = IntegerVector(1, i + 1);
-      CDFcounts[i] = 1;
-    }
-  } else {
-    for(int i = 0; i < numCDF; i++) {
-      CDFindices[i] = as<IntegerVector>(as<List>(pCDFindices)[i]);
-      CDFcounts[i] = CDFindices[i].length();
-    }
+  int numCDF = source.size();
+  // R-independent view of the CDFs with their counts and (sorted) indices
+  // (without indices, the i-th CDF belongs to the i-th p-value)
+  CDF_family family = source.family();
+  std::vector<IntegerVector> CDFindices(numCDF);
+  bool has_indices = pCDFindices.isNotNull() && as<List>(pCDFindices).length() > 0;
+  for(int i = 0; i < numCDF; i++) {
+    CDFindices[i] = has_indices ? as<IntegerVector>(as<List>(pCDFindices)[i]) : IntegerVector(1, i + 1.0);
+    family.counts[i] = CDFindices[i].length();
+    family.indices[i] = CDFindices[i].begin();
   }
-  // extract p-value CDF vectors and their lengths
-  NumericVector* sfuns = new NumericVector[numCDF];
-  for(int i = 0; i < numCDF; i++) sfuns[i] = as<NumericVector>(pCDFlist[i]);
   
   // vector to store transformed p-values
   NumericVector pval_transf(numTests);
-  // evaluation of current p-value CDF
-  NumericVector f_eval(numTests);
-  for(int i = 0; i < numCDF; i++) {
+  phase_timer timer;
+  // user interrupts can only be checked in between blocks of CDFs
+  stepwise_adjust(family, sorted_pv.begin(), numTests, independence, breakpoints, num_threads, pval_transf.begin(), [&](int from, int to) {
+    source.release(from, to);
     checkUserInterrupt();
-    
-    // current position in i-th CDF
-    int pos = 0;
-    // length of i-th CDF
-    int len = sfuns[i].length();
-    // current sorted p-value to which i-th CDF belongs
-    int k = 0;
-     
-    for(int j = 0; j < CDFindices[i][CDFcounts[i] - 1]; j++) {
-      // evaluate i-th CDF for all RELEVANT p-values and multiply with count 
-      f_eval[j] = eval_pv(sorted_pv[j], sfuns[i], len, pos);
-      //if(independence) f_eval[j] = std::log(1 - f_eval[j]);
-      f_eval[j] *= (CDFcounts[i] - k);
-      if(CDFindices[i][k] == j + 1) k++;
-    }
-    for(int j = CDFindices[i][CDFcounts[i] - 1]; j < numTests; j++)
-      f_eval[j] = 0;
-    
-    // add evaluations to overall sums
-    pval_transf += f_eval;
+  });
+  
+  if(profile) {
+    profile->seconds_eval += timer.lap();
+    double numCDFvalues = 0;
+    for(int i = 0; i < numCDF; i++) numCDFvalues += family.lens[i];
+    profile->cdf_evaluations += breakpoints ? numCDFvalues : (double)numCDF * numTests;
+    profile->working_bytes += (double)numTests * sizeof(double);
   }
-  //if(independence)
-    // revert log
-  //  pval_transf = 1 - exp(pval_transf);
-  
-  // compute adjustments
-  pval_transf[numTests - 1] = std::min<double>(1.0, pval_transf[numTests - 1]);
-  if(independence)
-    for(int i = numTests - 2; i >= 0; i--)
-      pval_transf[i] = std::min<double>(pval_transf[i], pval_transf[i + 1]);
-  else
-    for(int i = 1; i < numTests; i++)
-      pval_transf[i] = std::max<double>(pval_transf[i - 1], std::min<double>(1.0, pval_transf[i]));
-  
-  // garbage collection
-  delete[] sfuns;
-  delete[] CDFindices;
-  delete[] CDFcounts;
   
   return pval_transf;
 }
 
 List kernel_DFWER_stepwise_crit(
-    const List& pCDFlist,
+    const SEXP pCDFlist,
     const NumericVector& support,
     const NumericVector& sorted_pv,
-    const double alpha,
+    const NumericVector& alpha,
     const bool independence,
-    const Nullable<List>& pCDFindices
+    const Nullable<List>& pCDFindices,
+    const Nullable<NumericVector>& pCDFscales,
+    const bool prune,
+    kernel_profile* profile
 ) {
   // number of tests
   int numTests = sorted_pv.length();
+  // p-value CDFs
+  CDF_source source(pCDFlist, pCDFscales);
   // number of unique p-value distributions
-  int numCDF = pCDFlist.length();
+  int numCDF = source.size();
   // support size
   int numValues = support.length();
-  
-  // extract p-value CDF vectors and their lengths
-  NumericVector* sfuns = new NumericVector[numCDF];
-  int* lens = new int[numCDF];
+  // number of FWER levels
+  int numAlpha = alpha.length();
+  
+  // only support values up to the largest FWER level or observed p-value
+  // (and the next larger one) are needed, so the CDFs are truncated there
+  // (unless pruning is switched off)
+  double limit = std::max<double>(*std::max_element(alpha.begin(), alpha.end()), sorted_pv[numTests - 1]);
+  int numActive = prune ? active_support(support.begin(), numValues, limit) : numValues;
+  
+  // rank-encoded view of the truncated CDFs for the computations (prepared
+  // families already have the one of the complete CDFs)
+  phase_timer timer;
+  critical_workspace &ws = kernel_workspace;
+  prepared_family* prepared = source.prepared_for(support);
+  if(prepared == NULL)
+    ws.ranks.assign(truncate_family(source.family(), support[numActive - 1]), support.begin(), numActive);
+  const CDF_ranks &ranks = prepared ? prepared->ranks : ws.ranks;
+  
+  // counts and (sorted) indices of the CDFs (without indices, the i-th CDF
+  // belongs to the i-th p-value)
+  CDF_family family = source.family();
+  std::vector<IntegerVector> CDFindices(numCDF);
+  bool has_indices = pCDFindices.isNotNull() && as<List>(pCDFindices).length() > 0;
   for(int i = 0; i < numCDF; i++) {
-    sfuns[i] = as<NumericVector>(pCDFlist[i]);
-    lens[i] = sfuns[i].length();
+    CDFindices[i] = has_indices ? as<IntegerVector>(as<List>(pCDFindices)[i]) : IntegerVector(1, i + 1.0);
+    family.counts[i] = CDFindices[i].length();
+    family.indices[i] = CDFindices[i].begin();
   }
+  if(profile) profile->seconds_eval += timer.lap();
   
-  // indices of the CDFs and their counts
-  int* CDFcounts = new int[numCDF];
-  int* pv2CDFindices = new int[numTests];
-  if(pCDFindices.isNull() || as<List>(pCDFindices).length() == 0) {
-    for(int i = 0; i < numCDF; i++) {
-      CDFcounts[i] = 1;
-      pv2CDFindices[i] = i;
-    }
-  } else {
-    for(int i = 0; i < numCDF; i++) {
-      IntegerVector CDFindices = as<IntegerVector>(as<List>(pCDFindices)[i]);
-      CDFcounts[i] = CDFindices.length();
-      for(int j = 0; j < CDFcounts[i]; j++)
-        pv2CDFindices[CDFindices[j] - 1] = i;
-    }
-  }
-  // threshold
-  //double beta = independence ? -std::log(1 - alpha) : alpha;
+  // critical values of each FWER level and transformed sorted p-values; user
+  // interrupts are checked after each CDF and each block of tied p-values
+  NumericMatrix crit(numTests, numAlpha);
+  NumericVector pval_transf(numTests);
+  stepwise_critical(ranks, family, support.begin(), numValues, numActive, sorted_pv.begin(), numTests, alpha.begin(), numAlpha, independence, crit.begin(), pval_transf.begin(), ws, profile, [](int, int) {
+    checkUserInterrupt();
+  });
   
-  // vector to store transformed p-values
-  NumericVector pval_transf;
-  // evaluation of current p-value CDF
-  NumericVector f_eval(numValues);
+  if(profile) {
+    profile->support_size = numValues;
+    profile->active_support = numActive;
+    // critical values and transformed p-values
+    profile->working_bytes += (double)numTests * (numAlpha + 1) * sizeof(double);
+  }
   
-  // finding critical value of [d-Bonf]; reduce support first
-  int limit = binary_search(support, alpha / numTests, numValues);
-  NumericVector pv_list = support[Range(limit, numValues - 1)];
-  numValues -= limit;
-  limit = binary_search(pv_list, alpha, numValues);
-  pv_list = pv_list[Range(0, limit)];
-  numValues = limit + 1;
-  pval_transf = NumericVector(limit + 1);
+  // output results
+  return List::create(Named("crit_consts") = crit, Named("pval_transf") = pval_transf);
+}
+
+List kernel_DFWER_approx(
+  const SEXP pCDFlist,
+  const NumericVector& support,
+  const NumericVector& sorted_pv,
+  const NumericVector& alpha,
+  const bool independence,
+  const bool single_step,
+  const bool crit_consts,
+  const List& pCDFindices,
+  const int num_threads,
+  const Nullable<NumericVector>& pCDFscales,
+  kernel_profile* profile
+) {
+  // number of tests
+  int numTests = sorted_pv.length();
+  // number of FWER levels
+  int numAlpha = alpha.length();
+  // p-value CDFs
+  CDF_source source(pCDFlist, pCDFscales);
+  int numCDF = source.size();
+  
+  // R-independent view of the CDFs with their counts and (sorted) indices
+  CDF_family family = source.family();
+  std::vector<IntegerVector> CDFindices(numCDF);
   for(int i = 0; i < numCDF; i++) {
-    checkUserInterrupt();
-    int pos = 0;
-    for(int j = 0; j <= limit; j++) 
-      f_eval[j] = eval_pv(pv_list[j], sfuns[i], lens[i], pos);
-    //if(independence)
-    //  pval_transf += -CDFcounts[i] * log(1 - f_eval);
-    //else 
-      pval_transf += CDFcounts[i] * f_eval;
+    CDFindices[i] = as<IntegerVector>(pCDFindices[i]);
+    family.counts[i] = CDFindices[i].length();
+    family.indices[i] = CDFindices[i].begin();
   }
   
-  int idx_pval = binary_search(pval_transf, alpha, limit + 1);
-  pv_list = pv_list[Range(idx_pval, limit)];
-  double crit_1 = pv_list[0];
-  pv_list = sort_combine(pv_list, sorted_pv);
-  numValues = pv_list.length();
-  
-  // critical values indices
-  NumericVector crit(numTests, crit_1);
-  // index of current critical value to be computed
-  int idx_crit = numTests - 1;
-  // vector to store transformed p-values
-  pval_transf = NumericVector(numTests);
-  // current position in transformed support for transforming observed p-values
-  int idx_transf = numValues - 1;
-  // vector to store CDF sums
-  NumericVector pval_sums(numValues);
-  // array to store if a p-value is in the current combined support
-  LogicalVector supported(numValues);
-  // number of observed p-values in i,...,m equal to the current one
-  int count_pv = 0;
-  // array for storing counts of unique CDFs of a p-value "block"
-  int* CDFcounts_running = new int[numCDF];
+  // upper bounds of the adjusted sorted p-values, their certified errors and
+  // (if requested) critical values of single-step procedures
+  phase_timer timer;
+  NumericVector pval_transf(numTests), errors(numTests);
+  SEXP crit = R_NilValue;
+  int numPoints = numTests, numExact;
+  if(crit_consts) {
+    // only support values up to the largest FWER level or observed p-value
+    // (and the next larger one) are needed
+    double limit = *std::max_element(alpha.begin(), alpha.end());
+    if(numTests) limit = std::max<double>(limit, sorted_pv[numTests - 1]);
+    numPoints = active_support(support.begin(), support.length(), limit);
+    NumericVector crit_vals(numAlpha);
+    numExact = approximate_critical(family, support.begin(), support.length(), numPoints, independence, alpha.begin(), numAlpha, sorted_pv.begin(), numTests, num_threads, crit_vals.begin(), pval_transf.begin(), errors.begin());
+    crit = crit_vals;
+  } else {
+    numExact = approximate_adjust(family, sorted_pv.begin(), numTests, independence, single_step, alpha.begin(), numAlpha, num_threads, pval_transf.begin(), errors.begin());
+  }
   
-  // search for critical values and transform observed p-values
-  while(idx_crit >= 0) {
-    checkUserInterrupt();
-    
-    // number of observed p-values equal to current one ("block" size)
-    count_pv = 1;
-    while(
-      count_pv <= idx_crit && 
-        sorted_pv[idx_crit - count_pv] == sorted_pv[idx_crit]
-    )
-      count_pv++;
-    
-    // find current p-value in support for adjustment
-    while(idx_transf > 0 && pv_list[idx_transf] > sorted_pv[idx_crit]) 
-      idx_transf--;
-    
-    // determine critical value and transformation
-    if(count_pv == 1) {  // current p-value is unique
-      // index of CDF belonging to current p-value
-      int idx_CDF = pv2CDFindices[idx_crit];
-      // vector for evaluating current CDF
-      NumericVector f_eval(numValues);
-      
-      // evaluate CDF and add its attainable values to support
-      for(int i = 0; i < numValues; i++) {
-        int pos = 0;
-        f_eval[i] = eval_pv(pv_list[i], sfuns[idx_CDF], lens[idx_CDF], pos);
-        supported[i] = supported[i] || (f_eval[i] == pv_list[i]);
-      }
-      
-      // add evaluations to overall sums
-      //if(independence)
-      //  pval_sums += -log(1 - f_eval);
-      //else
-        pval_sums += f_eval;
-      
-      // find critical value
-      idx_pval = numValues - 1;
-      while(
-        idx_pval > 0 && 
-          (pval_sums[idx_pval] > alpha || !supported[idx_pval])
-      )
-        idx_pval--;
-      
-      // save critical value
-      crit[idx_crit] = pv_list[idx_pval];
-      
-      // compute transformed p-value
-      if(pv_list[idx_transf] == sorted_pv[idx_crit]) 
-      //  pval_transf[idx_crit] = independence 
-      //    ? 1 - std::exp(-pval_sums[idx_transf])
-      //    : pval_sums[idx_transf];
-        pval_transf[idx_crit] = std::min<double>(1.0, pval_sums[idx_transf]);
-      
-      // go to next critical value
-      idx_crit--;
-    } else {  // current p-value is not unique (i.e. in a "block")
-      // determine CDF counts for current "block"
-      for(int i = 0; i < numCDF; i++) CDFcounts_running[i] = 0;
-      // largest index of CDFs in "block"
-      int max_CDF = 0;
-      // index of current CDF
-      int idx_CDF = 0;
-      // determine counts and largest index
-      for(int i = idx_crit - count_pv + 1; i <= idx_crit; i++) {
-        idx_CDF = pv2CDFindices[i];
-        max_CDF = std::max<int>(max_CDF, idx_CDF);
-        CDFcounts_running[idx_CDF]++;
-      }
-      // index of last CDF for current p-value "block"
-      int idx_last = idx_CDF;
-      // last sum of current p-value
-      double pval_sum_last = pval_sums[idx_transf];
-      
-      for(idx_CDF = 0; idx_CDF <= max_CDF; idx_CDF++) {
-        if(CDFcounts_running[idx_CDF] > 0) {
-          // vector for evaluating current CDF
-          NumericVector f_eval(numValues);
-          // evaluate CDF and add its attainable values to support
-          for(int i = 0; i < numValues; i++) {
-            int pos = 0;
-            f_eval[i] = eval_pv(pv_list[i], sfuns[idx_CDF], lens[idx_CDF], pos);
-            supported[i] = supported[i] || (f_eval[i] == pv_list[i]);
-          }
-          // add evaluations to overall sums
-          //if(independence)
-          //  pval_sums += -log(1 - f_eval) * CDFcounts_running[idx_CDF];
-          //else
-            pval_sums += f_eval * CDFcounts_running[idx_CDF];
-          // compute adjustment for Hochberg procedure
-          if(independence && idx_CDF == idx_last)
-            pval_sum_last += f_eval[idx_transf];
-        }
-      }
-      
-      // find critical value
-      idx_pval = numValues - 1;
-      while(
-        idx_pval > 0 && 
-          (pval_sums[idx_pval] > alpha || !supported[idx_pval])
-      )
-        idx_pval--;
-      
-      // save critical values and transformed p-values
-      for(int i = idx_crit - count_pv + 1; i <= idx_crit; i++) {
-        // critical values
-        crit[i] = pv_list[idx_pval];
-        // transform p-value
-        if(pv_list[idx_transf] == sorted_pv[idx_crit]) 
-          //pval_transf[i] = independence
-          //  ? 1 - std::exp(-pval_sums[idx_transf])
-          //  : pval_sums[idx_transf];
-          pval_transf[i] = independence
-            ? std::min<double>(1.0, pval_sum_last)
-            : std::min<double>(1.0, pval_sums[idx_transf]);
-      }
-      
-      // go to next critical values
-      idx_crit -= count_pv;
+  if(profile) {
+    profile->seconds_eval += timer.lap();
+    if(crit_consts) {
+      profile->support_size = support.length();
+      profile->active_support = numPoints;
     }
+    double bins = numPoints ? std::ceil((double)numPoints / approx_bin_size(numPoints)) : 0;
+    profile->cdf_evaluations += (double)numCDF * (numExact + bins);
+    profile->working_bytes += (double)numPoints * (4 * sizeof(double) + 1) + (double)numTests * 2 * sizeof(double);
   }
   
-  /*if(independence) {
-    pval_transf[numTests - 1] = std::min<double>(1.0, pval_transf[numTests - 1]);
-    for(int i = numTests - 2; i >= 0; i--)
-      pval_transf[i] = std::min<double>(pval_transf[i], pval_transf[i + 1]);
-  } else {
-    pval_transf[0] = std::min<double>(1.0, pval_transf[0]);
-    for(int i = 1; i < numTests; i++)
-      pval_transf[i] = std::max<double>(pval_transf[i - 1], std::min<double>(1.0, pval_transf[i]));
-  }*/
+  // return (upper bounds of the) adjusted sorted p-values, their errors, the
+  // critical values and the number of exactly evaluated points
+  return List::create(
+    Named("crit_consts") = crit,
+    Named("pval_transf") = pval_transf,
+    Named("errors") = errors,
+    Named("exact") = numExact
+  );
+}
+
+List kernel_DFWER_rejections(
+  const SEXP pCDFlist,
+  const NumericVector& sorted_pv,
+  const NumericVector& alpha,
+  const bool independence,
+  const bool single_step,
+  const List& pCDFindices,
+  const bool breakpoints,
+  const double max_cost,
+  const int num_threads,
+  const Nullable<NumericVector>& pCDFscales,
+  kernel_profile* profile
+) {
+  // number of tests
+  int numTests = sorted_pv.length();
+  // number of FWER levels
+  int numAlpha = alpha.length();
+  // p-value CDFs
+  CDF_source source(pCDFlist, pCDFscales);
+  int numCDF = source.size();
+  
+  // R-independent view of the CDFs with their counts and (sorted) indices
+  CDF_family family = source.family();
+  std::vector<IntegerVector> CDFindices(numCDF);
+  for(int i = 0; i < numCDF; i++) {
+    CDFindices[i] = as<IntegerVector>(pCDFindices[i]);
+    family.counts[i] = CDFindices[i].length();
+    family.indices[i] = CDFindices[i].begin();
+  }
   
-  // garbage collection
-  delete[] CDFcounts_running;
-  delete[] pv2CDFindices;
-  delete[] CDFcounts;
-  delete[] lens;
-  delete[] sfuns;
+  // needed adjusted sorted p-values and numbers of rejections
+  phase_timer timer;
+  NumericVector pval_transf(numTests);
+  IntegerVector num_rejected(numAlpha);
+  // user interrupts can only be checked in between blocks of CDFs
+  int numEvaluated = early_rejections(family, sorted_pv.begin(), numTests, independence, single_step, alpha.begin(), numAlpha, breakpoints, max_cost, num_threads, pval_transf.begin(), num_rejected.begin(), [&](int from, int to) {
+    source.release(from, to);
+    checkUserInterrupt();
+  });
+  // p-values that were not needed are missing
+  for(int j = 0; j < numTests; j++) if(std::isnan(pval_transf[j])) pval_transf[j] = NA_REAL;
+  
+  if(profile) {
+    profile->seconds_eval += timer.lap();
+    profile->cdf_evaluations += (double)numCDF * numEvaluated;
+    profile->working_bytes += (double)numTests * sizeof(double);
+  }
   
-  // output results
-  return List::create(Named("crit_consts") = crit, Named("pval_transf") = pval_transf);
+  // return adjusted sorted p-values, numbers of rejections and the number of
+  // evaluated p-values
+  return List::create(
+    Named("pval_transf") = pval_transf,
+    Named("num_rejected") = num_rejected,
+    Named("evaluated") = numEvaluated
+  );
 }
 /*
 // [[Rcpp::export]]
@@ -15,6 +15,10 @@
 //' constants. The end user should not use these functions directly, as they are
 //' internal functions and parameters (including their names, order, etc.) may
 //' be changed without notice!
+//' Instead of a list, `pCDFlist` may also be the external pointer of a prepared
+//' family that was created by `prepare_family_int()`.
+//' For the fast kernels, it may also be the file name of a CDF store that was
+//' written by `write_CDF_store_int()`.
 //' 
 //' @templateVar pCDFlist TRUE
 //' @template param
@@ -35,8 +39,9 @@
 //'                       p-value supports.
 //' @param sorted_pv      numeric vector, sorted in increasing order, containing
 //'                       the raw p-values.
-//' @param alpha          single real number strictly between 0 and 1 indicating
-//'                       the target FWER level.
+//' @param alpha          numeric vector of real numbers strictly between 0 and
+//'                       1 indicating the target FWER levels; the CDFs are
+//'                       evaluated only once for all of them.
 //' @param pCDFindices    list of integer vectors containing the indices that
 //'                       indicate to which raw \eqn{p}-value in `sorted_pv`
 //'                       each item in `pCDFlist` belongs, and must have the
@@ -46,12 +51,29 @@
 //'                       item to the second \eqn{p}-value etc. in which case
 //'                       the lengths of `pCDFlist` and `sorted_pv` must be
 //'                       equal.
+//' @param breakpoints    single boolean specifying whether the sums of the CDFs
+//'                       are accumulated at their breakpoints by a single
+//'                       cumulative sum instead of evaluating each CDF at each
+//'                       p-value; this is much faster if there are many
+//'                       unique CDFs, but results may differ in the last bits
+//'                       due to the different order of summation.
+//' @param num_threads    single positive integer specifying the number of
+//'                       threads among which the evaluation points are split;
+//'                       results do not depend on it.
+//' @param pCDFscales     optional numeric vector of positive scale factors,
+//'                       one for each CDF; if it is not `NULL`, the i-th CDF
+//'                       is divided by the i-th factor and only its values
+//'                       `<= 1` are used (e.g. after selection of p-values),
+//'                       without copying the CDFs.
 //' 
 //' @return
 //' For `kernel_DFWER_singlestep_fast()` and `kernel_DFWER_stepwise_fast()` a
 //' vector of transformed p-values is returned. `kernel_DFWER_singlestep_crit`
 //' and `kernel_DFWER_stepwise_crit` return a list with critical constants
-//' (`$crit_consts`) and adjusted p-values (`$pval_transf`).
+//' (`$crit_consts`) and adjusted p-values (`$pval_transf`). The critical
+//' constants are a vector with one value per FWER level for
+//' `kernel_DFWER_singlestep_crit` and a matrix with one column per FWER level
+//' for `kernel_DFWER_stepwise_crit`.
 //' 
 //' @seealso
 //' [`discrete_FWER()`], [`direct_discrete_FWER()`]
@@ -59,16 +81,443 @@
 
 //' @rdname kernel
 // [[Rcpp::export]]
-NumericVector kernel_DFWER_singlestep_fast(const List& pCDFlist, const NumericVector& pvalues, const bool independence = false, const Nullable<IntegerVector>& pCDFcounts = R_NilValue);
+NumericVector kernel_DFWER_singlestep_fast(const SEXP pCDFlist, const NumericVector& pvalues, const bool independence = false, const Nullable<IntegerVector>& pCDFcounts = R_NilValue, const bool breakpoints = false, const int num_threads = 1, const Nullable<NumericVector>& pCDFscales = R_NilValue);
 
 //' @rdname kernel
 // [[Rcpp::export]]
-List kernel_DFWER_singlestep_crit(const List& pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const double alpha = 0.05, const bool independence = false, const Nullable<IntegerVector>& pCDFcounts = R_NilValue);
+List kernel_DFWER_singlestep_crit(const SEXP pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const NumericVector& alpha = NumericVector::create(0.05), const bool independence = false, const Nullable<IntegerVector>& pCDFcounts = R_NilValue, const int num_threads = 1, const Nullable<NumericVector>& pCDFscales = R_NilValue);
 
 //' @rdname kernel
 // [[Rcpp::export]]
-NumericVector kernel_DFWER_stepwise_fast(const List& pCDFlist, const NumericVector& sorted_pv, const bool independence = false, const Nullable<List>& pCDFindices = R_NilValue);
+NumericVector kernel_DFWER_stepwise_fast(const SEXP pCDFlist, const NumericVector& sorted_pv, const bool independence = false, const Nullable<List>& pCDFindices = R_NilValue, const bool breakpoints = false, const int num_threads = 1, const Nullable<NumericVector>& pCDFscales = R_NilValue);
 
 //' @rdname kernel
 // [[Rcpp::export]]
-List kernel_DFWER_stepwise_crit(const List& pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const double alpha = 0.05, const bool independence = false, const Nullable<List>& pCDFindices = R_NilValue);
+List kernel_DFWER_stepwise_crit(const SEXP pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const NumericVector& alpha = NumericVector::create(0.05), const bool independence = false, const Nullable<List>& pCDFindices = R_NilValue, const Nullable<NumericVector>& pCDFscales = R_NilValue);
+
+// versions of the kernels that additionally record timings and counters in
+// 'profile' (if it is not NULL); the ones for critical values only prune the
+// support, if 'prune' is true
+NumericVector kernel_DFWER_singlestep_fast(const SEXP pCDFlist, const NumericVector& pvalues, const bool independence, const Nullable<IntegerVector>& pCDFcounts, const bool breakpoints, const int num_threads, const Nullable<NumericVector>& pCDFscales, kernel_profile* profile);
+List kernel_DFWER_singlestep_crit(const SEXP pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const NumericVector& alpha, const bool independence, const Nullable<IntegerVector>& pCDFcounts, const int num_threads, const Nullable<NumericVector>& pCDFscales, const bool prune, kernel_profile* profile);
+NumericVector kernel_DFWER_stepwise_fast(const SEXP pCDFlist, const NumericVector& sorted_pv, const bool independence, const Nullable<List>& pCDFindices, const bool breakpoints, const int num_threads, const Nullable<NumericVector>& pCDFscales, kernel_profile* profile);
+List kernel_DFWER_stepwise_crit(const SEXP pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const NumericVector& alpha, const bool independence, const Nullable<List>& pCDFindices, const Nullable<NumericVector>& pCDFscales, const bool prune, kernel_profile* profile);
+
+// bounded approximation of the adjusted p-values (engine "approx"), which
+// evaluates the CDFs exactly only where the bounds do not determine the
+// rejections at the FWER levels 'alpha', and of the critical values of
+// single-step procedures (if 'crit_consts' is true); 'pCDFindices' contains
+// the sorted indices of all CDFs; returns a list with the critical constants
+// (or NULL), the upper bounds of the adjusted sorted p-values, their
+// certified errors and the number of exactly evaluated points
+List kernel_DFWER_approx(const SEXP pCDFlist, const NumericVector& support, const NumericVector& sorted_pv, const NumericVector& alpha, const bool independence, const bool single_step, const bool crit_consts, const List& pCDFindices, const int num_threads, const Nullable<NumericVector>& pCDFscales, kernel_profile* profile);
+
+// numbers of rejections at the FWER levels 'alpha' (engine "rejections"),
+// which only evaluates the CDFs at the sorted p-values that are needed to
+// determine them, unless this costs more than 'max_cost' operations (then all
+// of them are computed, at the breakpoints, if 'breakpoints' is true);
+// 'pCDFindices' contains the sorted indices of all CDFs; returns a list with
+// the adjusted sorted p-values (NA where they were not needed), the numbers
+// of rejections and the number of evaluated p-values
+List kernel_DFWER_rejections(const SEXP pCDFlist, const NumericVector& sorted_pv, const NumericVector& alpha, const bool independence, const bool single_step, const List& pCDFindices, const bool breakpoints, const double max_cost, const int num_threads, const Nullable<NumericVector>& pCDFscales, kernel_profile* profile);
+
+//' @name prepare_family_int
+//' 
+//' @keywords internal
+//' 
+//' @title
+//' Native Storage of Prepared Families
+//' 
+//' @description
+//' `prepare_family_int()` copies the p-value CDFs into native storage, builds
+//' their overall support and rank encoding and returns an external pointer to
+//' it, which can be passed to the kernels instead of `pCDFlist`. The
+//' transformed support of single-step procedures is cached in it as soon as it
+//' has been computed. As external pointers cannot be serialized,
+//' `prepared_valid()` checks whether such a pointer is (still) valid.
+//' `prepared_support()` returns the overall support of a prepared family.
+//' 
+//' @templateVar pCDFlist TRUE
+//' @template param
+//' 
+//' @param family         external pointer created by `prepare_family_int()`.
+//' 
+//' @seealso
+//' [`prepare_family()`], [`kernel`]
+//'
+
+//' @rdname prepare_family_int
+// [[Rcpp::export]]
+SEXP prepare_family_int(const List& pCDFlist);
+
+//' @rdname prepare_family_int
+// [[Rcpp::export]]
+bool prepared_valid(const SEXP family);
+
+//' @rdname prepare_family_int
+// [[Rcpp::export]]
+NumericVector prepared_support(const SEXP family);
+
+//' @name CDF_store_int
+//' 
+//' @keywords internal
+//' 
+//' @title
+//' Native Access to CDF Stores
+//' 
+//' @description
+//' `write_CDF_store_int()` writes p-value CDFs (and their indices, if given) to
+//' a binary store file, whose name can be passed to the fast kernels instead of
+//' `pCDFlist`. The kernels memory-map the file and stream through the CDFs in
+//' blocks, so that the family does not have to fit into memory.
+//' `CDF_store_info()` checks a store file and returns the number of CDFs
+//' (`$numCDF`), their total number of values (`$numValues`) and their indices
+//' (`$pCDFindices`, `NULL` if the store does not contain any).
+//' 
+//' @templateVar pCDFlist TRUE
+//' @template param
+//' 
+//' @param file           single character string with the name of the store
+//'                       file.
+//' @param pCDFindices    list of integer vectors containing the indices of the
+//'                       p-values to which each CDF belongs, or `NULL`.
+//' 
+//' @seealso
+//' [`write_CDF_store()`], [`kernel`]
+//'
+
+//' @rdname CDF_store_int
+// [[Rcpp::export]]
+void write_CDF_store_int(const List& pCDFlist, const std::string& file, const Nullable<List>& pCDFindices = R_NilValue);
+
+//' @rdname CDF_store_int
+// [[Rcpp::export]]
+List CDF_store_info(const std::string& file);
+
+//' @name discrete_fwer_native
+//' 
+//' @keywords internal
+//' 
+//' @title
+//' Native Processing of Discrete FWER Procedures
+//' 
+//' @description
+//' Performs the computations of [`discrete_FWER()`] after the selection of
+//' p-values: sorts the p-values, remaps the indices of the CDFs to the sorted
+//' order, builds the overall support by a k-way merge of the CDFs (only for
+//' critical values), chooses the evaluation strategy of the kernels and their
+//' number of threads by a cost model, calls the respective kernel and determines the rejected
+//' p-values of each FWER level.
+//' 
+//' @param pCDFlist       list of the supports of the CDFs of the p-values, the
+//'                       external pointer of a prepared family or the file
+//'                       name of a CDF store (see [`kernel`]).
+//' @param pvalues        numeric vector of the (selected) p-values in their
+//'                       original order.
+//' @param pCDFindices    list of integer vectors containing the indices of the
+//'                       p-values in `pvalues` to which each CDF belongs; if
+//'                       `NULL`, the i-th CDF belongs to the i-th p-value.
+//' @param alpha          numeric vector of FWER levels.
+//' @param independence   single boolean specifying whether the \eqn{p}-values
+//'                       are independent.
+//' @param single_step    single boolean specifying whether a single-step or
+//'                       stepwise procedure is performed.
+//' @param crit_consts    single boolean specifying whether critical constants
+//'                       are computed.
+//' @param num_threads    single positive integer specifying the number of
+//'                       threads used by the kernels.
+//' @param pCDFscales     optional numeric vector of scale factors of the CDFs
+//'                       (see [`kernel`]), e.g. their values at the selection
+//'                       threshold.
+//' @param profile        single boolean specifying whether the timings and
+//'                       counters of the phases are recorded.
+//' @param engine         single character string specifying the evaluation
+//'                       strategy; `"auto"` chooses it by a cost model,
+//'                       `"scan"` and `"breakpoints"` (adjusted p-values
+//'                       only) and `"pruned"` and `"full"` (critical values
+//'                       only; support pruned at the largest relevant value
+//'                       or not) enforce it with all `num_threads` threads;
+//'                       `"approx"` bounds the sums between the points of a
+//'                       coarse grid and evaluates them exactly only where
+//'                       the bounds do not determine the rejections (adjusted
+//'                       p-values and single-step critical values only);
+//'                       `"rejections"` (adjusted p-values only) stops as
+//'                       soon as the rejections are determined.
+//' 
+//' @return
+//' A list with the adjusted p-values in the original order (`$Adjusted`), the
+//' critical constants (`$Critical_values`; `NULL`, if they were not computed),
+//' the number of rejections of each FWER level (`$Num_rejected`), for each
+//' level, the (1-based) indices of the rejected p-values (`$Indices`) and, if
+//' `profile = TRUE`, a list (`$Profile`) with the seconds (`$Seconds`) and the
+//' estimated working memory in bytes (`$Bytes`) of the native phases and the
+//' counters of the kernel (`$Counters`), i.e. the number of CDF evaluations,
+//' the support size before and after pruning and the number of blocks of
+//' tied p-values processed by the stepwise search for critical values
+//' (otherwise, `$Profile` is `NULL`) and a list (`$Plan`) with the chosen
+//' evaluation strategy (`$Engine`), whether it was chosen automatically
+//' (`$Automatic`), the number of threads (`$Threads`), its estimated number of
+//' operations (`$Cost`) and the statistics of the family it is based on
+//' (`$Statistics`). For `engine = "approx"`, the adjusted p-values are upper
+//' bounds and `$Approximation` is a list with their certified errors in the
+//' original order (`$Errors`), their maximum (`$Max_error`) and the number of
+//' exactly evaluated points (`$Exact_points`); otherwise, it is `NULL`. For
+//' `engine = "rejections"`, the adjusted p-values that were not needed are
+//' `NA`.
+//' 
+//' @seealso
+//' [`discrete_FWER()`], [`kernel`]
+//'
+
+//' @rdname discrete_fwer_native
+// [[Rcpp::export]]
+List discrete_fwer_native(const SEXP pCDFlist, const NumericVector& pvalues, const Nullable<List>& pCDFindices, const NumericVector& alpha, const bool independence, const bool single_step, const bool crit_consts, const int num_threads = 1, const Nullable<NumericVector>& pCDFscales = R_NilValue, const bool profile = false, const std::string& engine = "auto");
+
+//' @name match_pvals_int
+//' 
+//' @keywords internal
+//' 
+//' @title
+//' Native Matching of Raw P-Values with Supports
+//' 
+//' @description
+//' Replaces each p-value that is not a value of its CDF by its nearest
+//' neighbour in that CDF (the smaller one, if both neighbours are equally
+//' near). The p-values are located by binary search and processed by the CDF
+//' they belong to. Used by [`match_pvals()`].
+//' 
+//' @param pvalues        numeric vector of raw p-values.
+//' @param pCDFlist       list of the supports of the CDFs of the p-values.
+//' @param pCDFindices    list of integer vectors containing the indices of the
+//'                       p-values to which each CDF belongs; if `NULL`, the
+//'                       i-th CDF belongs to the i-th p-value.
+//' 
+//' @return
+//' A list with the matched p-values (`$pvalues`) and the (1-based) indices of
+//' the rounded ones (`$rounded`).
+//' 
+//' @seealso
+//' [`match_pvals()`]
+//'
+
+//' @rdname match_pvals_int
+// [[Rcpp::export]]
+List match_pvals_int(const NumericVector& pvalues, const List& pCDFlist, const Nullable<List>& pCDFindices = R_NilValue);
+
+//' @name eval_CDFs_int
+//' 
+//' @keywords internal
+//' 
+//' @title
+//' Native Evaluation of P-Value CDFs at a Single Point
+//' 
+//' @description
+//' Evaluates each CDF at `x` by binary search, i.e. determines the largest
+//' value of each CDF that is `<= x` (or 0, if there is none). Used for the
+//' scale factors of selection.
+//' 
+//' @param pCDFlist       list of the supports of the CDFs of the p-values.
+//' @param x              single number at which the CDFs are evaluated.
+//' 
+//' @return
+//' A numeric vector with the value of each CDF at `x`.
+//' 
+//' @seealso
+//' [`discrete_FWER()`]
+//'
+
+//' @rdname eval_CDFs_int
+// [[Rcpp::export]]
+NumericVector eval_CDFs_int(const List& pCDFlist, const double x);
+
+//' @name deduplicate_CDFs_int
+//' 
+//' @keywords internal
+//' 
+//' @title
+//' Native Detection of Identical P-Value CDFs
+//' 
+//' @description
+//' Detects identical p-value CDFs by hashing their values; CDFs with equal
+//' hashes are compared value by value, so hash collisions cannot merge
+//' different CDFs.
+//' 
+//' @templateVar pCDFlist TRUE
+//' @template param
+//' 
+//' @return
+//' A list with the (1-based) positions of the first occurrence of each unique
+//' CDF in `pCDFlist` (`$unique`) and, for each unique CDF, the positions of all
+//' of its occurrences (`$indices`).
+//' 
+//' @seealso
+//' [`discrete_FWER()`]
+//'
+
+//' @rdname deduplicate_CDFs_int
+// [[Rcpp::export]]
+List deduplicate_CDFs_int(const List& pCDFlist);
+
+//' @name discrete_fwer_batch_int
+//' 
+//' @keywords internal
+//' 
+//' @title
+//' Native Analysis of Many Families
+//' 
+//' @description
+//' Computes the adjusted p-values of many independent families with a single
+//' call. The families are checked serially and then analysed in parallel, one
+//' family per thread, in the order of decreasing estimated cost; idle threads
+//' take the next remaining family. Used by [`discrete_FWER_batch()`].
+//' 
+//' @param families       list of families, each a list with the raw p-values
+//'                       (`$pvalues`), the supports of their unique CDFs
+//'                       (`$pCDFlist`) and the (1-based) indices of the
+//'                       p-values to which each CDF belongs (`$pCDFindices`;
+//'                       if `NULL`, the i-th CDF belongs to the i-th p-value).
+//' @param alpha          numeric vector of real numbers strictly between 0 and
+//'                       1 indicating the target FWER levels.
+//' @param independence   single boolean specifying whether the \eqn{p}-values
+//'                       are independent.
+//' @param single_step    single boolean specifying whether a single-step
+//'                       procedure is performed.
+//' @param num_threads    single positive integer specifying the number of
+//'                       families that are analysed at the same time.
+//' 
+//' @return
+//' A list with the adjusted p-values of each family in their original order
+//' (`$Adjusted`) and an integer matrix with the number of rejections of each
+//' family (rows) and FWER level (columns) (`$Num_rejected`).
+//' 
+//' @seealso
+//' [`discrete_FWER_batch()`], [`discrete_fwer_native`]
+//'
+
+//' @rdname discrete_fwer_batch_int
+// [[Rcpp::export]]
+List discrete_fwer_batch_int(const List& families, const NumericVector& alpha, const bool independence, const bool single_step, const int num_threads = 1);
+
+//' @name shard_int
+//' 
+//' @keywords internal
+//' 
+//' @title
+//' Native Mergeable Shards of Single-Step Procedures
+//' 
+//' @description
+//' `singlestep_shard_int()` computes the untransformed sums of the
+//' single-step procedures over a subset of the CDFs of a family at their
+//' support values up to `limit` (and the next larger one) and serializes them
+//' as a raw vector. `merge_shards_int()` merges shards of disjoint subsets of
+//' the CDFs into one, which is again a shard. `finalize_shard_int()` computes
+//' the critical constants and adjusted p-values from a merged shard of all
+//' CDFs. `shard_info_int()` checks a shard and returns its dependence mode
+//' (`$independence`), its limit (`$limit`), its numbers of CDFs
+//' (`$num_CDFs`) and of p-values to which they belong (`$num_tests`) and the
+//' number of its support values (`$num_points`).
+//' 
+//' @templateVar pCDFlist TRUE
+//' @template param
+//' 
+//' @param pCDFcounts     integer vector of counts that indicates to how many
+//'                       p-values each CDF belongs; if `NULL`, each CDF
+//'                       belongs to one p-value.
+//' @param independence   single boolean specifying whether the \eqn{p}-values
+//'                       are independent.
+//' @param limit          single number specifying the largest value at which
+//'                       the sums are needed, i.e. the largest FWER level or
+//'                       observed p-value.
+//' @param num_threads    single positive integer specifying the number of
+//'                       threads.
+//' @param shards         list of shards (raw vectors).
+//' @param shard          single shard (raw vector).
+//' @param sorted_pv      numeric vector, sorted in increasing order, containing
+//'                       the raw p-values.
+//' @param alpha          numeric vector of FWER levels.
+//' 
+//' @return
+//' `singlestep_shard_int()` and `merge_shards_int()` return a raw vector.
+//' `finalize_shard_int()` returns a list with the critical constants
+//' (`$crit_consts`) and the adjusted sorted p-values (`$pval_transf`).
+//' 
+//' @seealso
+//' [`singlestep_shard()`], [`kernel`]
+//'
+
+//' @rdname shard_int
+// [[Rcpp::export]]
+RawVector singlestep_shard_int(const List& pCDFlist, const Nullable<IntegerVector>& pCDFcounts = R_NilValue, const bool independence = false, const double limit = 1, const int num_threads = 1);
+
+//' @rdname shard_int
+// [[Rcpp::export]]
+RawVector merge_shards_int(const List& shards);
+
+//' @rdname shard_int
+// [[Rcpp::export]]
+List finalize_shard_int(const RawVector& shard, const NumericVector& sorted_pv, const NumericVector& alpha);
+
+//' @rdname shard_int
+// [[Rcpp::export]]
+List shard_info_int(const RawVector& shard);
+
+//' @name incremental_int
+//' 
+//' @keywords internal
+//' 
+//' @title
+//' Native Incremental Analyses
+//' 
+//' @description
+//' `incremental_create_int()` creates an empty incremental analysis and
+//' returns its external pointer. `incremental_valid()` checks whether such a
+//' pointer is (still) valid. `incremental_append_int()` absorbs a batch of
+//' new p-values and their CDFs without evaluating the CDFs of earlier batches
+//' again. `incremental_results_int()` computes the adjusted p-values,
+//' rejections and (for single-step procedures only) critical values of all
+//' p-values so far.
+//' 
+//' @templateVar pCDFlist TRUE
+//' @template param
+//' 
+//' @param family         external pointer created by
+//'                       `incremental_create_int()`.
+//' @param independence   single boolean specifying whether the \eqn{p}-values
+//'                       are independent.
+//' @param single_step    single boolean specifying whether a single-step
+//'                       procedure is performed.
+//' @param pvalues        numeric vector of the new p-values.
+//' @param pCDFindices    list of integer vectors with the (1-based) indices of
+//'                       the new p-values to which each CDF belongs; if
+//'                       `NULL`, the i-th CDF belongs to the i-th p-value.
+//' @param num_threads    single positive integer specifying the number of
+//'                       threads.
+//' @param alpha          numeric vector of FWER levels.
+//' @param crit_consts    single boolean specifying whether critical constants
+//'                       are to be computed.
+//' 
+//' @return
+//' `incremental_results_int()` returns a list with the adjusted p-values in
+//' their original order (`$Adjusted`), the critical values (`$Critical_values`
+//' or `NULL`), the numbers of rejections (`$Num_rejected`) and the indices of
+//' the rejected p-values (`$Indices`) of each FWER level.
+//' 
+//' @seealso
+//' [`incremental_FWER()`], [`kernel`]
+//'
+
+//' @rdname incremental_int
+// [[Rcpp::export]]
+SEXP incremental_create_int(const bool independence, const bool single_step);
+
+//' @rdname incremental_int
+// [[Rcpp::export]]
+bool incremental_valid(const SEXP family);
+
+//' @rdname incremental_int
+// [[Rcpp::export]]
+void incremental_append_int(const SEXP family, const List& pCDFlist, const NumericVector& pvalues, const Nullable<List>& pCDFindices = R_NilValue, const int num_threads = 1);
+
+//' @rdname incremental_int
+// [[Rcpp::export]]
+List incremental_results_int(const SEXP family, const NumericVector& alpha, const bool crit_consts = false);
@@ -0,0 +1,60 @@
+#include "kernel.h"
+
+List match_pvals_int(const NumericVector& pvalues, const List& pCDFlist, const Nullable<List>& pCDFindices) {
+  // number of p-values and of unique CDFs
+  int numTests = pvalues.length();
+  int numCDF = pCDFlist.length();
+  bool has_indices = pCDFindices.isNotNull();
+  List indices = has_indices ? as<List>(pCDFindices) : List(0);
+  if((has_indices && indices.length() != numCDF) || (!has_indices && numCDF != numTests))
+    stop("'pCDFlist' and 'test_results' do not match");
+  
+  // matched p-values and whether each of them had to be rounded
+  NumericVector pvec = clone(pvalues);
+  std::vector<char> rounded(numTests, 0);
+  std::vector<char> seen(numTests, 0);
+  int numRounded = 0, numSeen = 0;
+  // p-values are processed by the CDF they belong to, so that each CDF is
+  // accessed only once
+  for(int i = 0; i < numCDF; i++) {
+    NumericVector sfun = as<NumericVector>(pCDFlist[i]);
+    const double* begin = sfun.begin();
+    const double* end = sfun.end();
+    IntegerVector idx = has_indices ? as<IntegerVector>(indices[i]) : IntegerVector(1, (double)(i + 1));
+    for(int k = 0; k < idx.length(); k++) {
+      int j = idx[k] - 1;
+      if(j < 0 || j >= numTests || seen[j]) stop("'pCDFlist' and 'test_results' do not match");
+      seen[j] = 1;
+      numSeen++;
+      if(begin == end) continue;
+      // first CDF value >= the p-value; if it is not equal, the nearest of it
+      // and its predecessor is used (the smaller one, if both are equally near)
+      const double* pos = std::lower_bound(begin, end, pvalues[j]);
+      if(pos != end && *pos == pvalues[j]) continue;
+      if(pos == end || (pos != begin && pvalues[j] - *(pos - 1) <= *pos - pvalues[j])) pos--;
+      pvec[j] = *pos;
+      rounded[j] = 1;
+      numRounded++;
+    }
+  }
+  if(numSeen != numTests) stop("'pCDFlist' and 'test_results' do not match");
+  
+  // (1-based) indices of the rounded p-values
+  IntegerVector idx_rounded(numRounded);
+  for(int j = 0, l = 0; j < numTests; j++) if(rounded[j]) idx_rounded[l++] = j + 1;
+  
+  return List::create(Named("pvalues") = pvec, Named("rounded") = idx_rounded);
+}
+
+NumericVector eval_CDFs_int(const List& pCDFlist, const double x) {
+  int numCDF = pCDFlist.length();
+  NumericVector res(numCDF);
+  for(int i = 0; i < numCDF; i++) {
+    NumericVector sfun = as<NumericVector>(pCDFlist[i]);
+    // largest CDF value <= x (0, if there is none)
+    const double* pos = std::upper_bound(sfun.begin(), sfun.end(), x);
+    res[i] = pos == sfun.begin() ? 0 : *(pos - 1);
+  }
+  
+  return res;
+}
@@ -0,0 +1,20 @@
+#include "kernel.h"
+
+SEXP prepare_family_int(const List& pCDFlist) {
+  // copy CDFs into native storage and build support and rank encoding
+  CDF_source source(pCDFlist);
+  XPtr<prepared_family> family(new prepared_family(source.family()), true);
+  
+  return family;
+}
+
+bool prepared_valid(const SEXP family) {
+  return TYPEOF(family) == EXTPTRSXP && XPtr<prepared_family>(family).get() != NULL;
+}
+
+NumericVector prepared_support(const SEXP family) {
+  CDF_source source(family);
+  if(source.prepared == NULL) stop("'family' must be a prepared family!");
+  
+  return NumericVector(source.prepared->support.begin(), source.prepared->support.end());
+}
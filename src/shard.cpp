@@ -0,0 +1,75 @@
+#include "kernel.h"
+
+// shard from a raw vector
+static singlestep_shard shard_from_raw(const RawVector& shard) {
+  return deserialize_shard(shard.begin(), shard.length());
+}
+
+// raw vector of a shard
+static RawVector shard_to_raw(const singlestep_shard& shard) {
+  std::vector<unsigned char> bytes = serialize_shard(shard);
+  return RawVector(bytes.begin(), bytes.end());
+}
+
+RawVector singlestep_shard_int(
+  const List& pCDFlist,
+  const Nullable<IntegerVector>& pCDFcounts,
+  const bool independence,
+  const double limit,
+  const int num_threads
+) {
+  // p-value CDFs and their counts
+  CDF_source source(pCDFlist);
+  CDF_family family = source.family();
+  IntegerVector CDFcounts;
+  if(pCDFcounts.isNull() || as<IntegerVector>(pCDFcounts).length() == 0)
+    CDFcounts = IntegerVector(family.numCDF, 1.0);
+  else
+    CDFcounts = pCDFcounts;
+  if(CDFcounts.length() != family.numCDF) stop("Number of counts must equal the number of CDFs!");
+  for(int i = 0; i < family.numCDF; i++) family.counts[i] = CDFcounts[i];
+
+  return shard_to_raw(make_shard(family, independence, limit, num_threads));
+}
+
+RawVector merge_shards_int(const List& shards) {
+  std::vector<singlestep_shard> parts(shards.length());
+  std::vector<const singlestep_shard*> ptrs(shards.length());
+  for(int s = 0; s < shards.length(); s++) {
+    parts[s] = shard_from_raw(as<RawVector>(shards[s]));
+    ptrs[s] = &parts[s];
+  }
+
+  return shard_to_raw(merge_shards(ptrs));
+}
+
+List finalize_shard_int(
+  const RawVector& shard,
+  const NumericVector& sorted_pv,
+  const NumericVector& alpha
+) {
+  singlestep_shard merged = shard_from_raw(shard);
+  if(merged.numTests != (uint64_t)sorted_pv.length())
+    stop("Shards contain CDFs of %i p-values, but %i p-values were given!", (int)merged.numTests, (int)sorted_pv.length());
+  if(sorted_pv.length() && sorted_pv[sorted_pv.length() - 1] > merged.limit)
+    stop("P-values must not exceed the limit of the shards!");
+  if(alpha.length() && *std::max_element(alpha.begin(), alpha.end()) > merged.limit)
+    stop("FWER levels must not exceed the limit of the shards!");
+
+  NumericVector crit(alpha.length()), pval_transf(sorted_pv.length());
+  finalize_shard(merged, alpha.begin(), alpha.length(), sorted_pv.begin(), sorted_pv.length(), crit.begin(), pval_transf.begin());
+
+  return List::create(Named("crit_consts") = crit, Named("pval_transf") = pval_transf);
+}
+
+List shard_info_int(const RawVector& shard) {
+  singlestep_shard info = shard_from_raw(shard);
+
+  return List::create(
+    Named("independence") = info.independence,
+    Named("limit") = info.limit,
+    Named("num_CDFs") = (double)info.numCDF,
+    Named("num_tests") = (double)info.numTests,
+    Named("num_points") = (int)info.points.size()
+  );
+}
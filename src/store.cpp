@@ -0,0 +1,42 @@
+#include "kernel.h"
+
+void write_CDF_store_int(const List& pCDFlist, const std::string& file, const Nullable<List>& pCDFindices) {
+  CDF_source source(pCDFlist);
+  CDF_family family = source.family();
+  // indices (if any)
+  bool with_indices = pCDFindices.isNotNull();
+  std::vector<IntegerVector> CDFindices;
+  if(with_indices) {
+    List indices(pCDFindices);
+    if(indices.length() != family.numCDF) stop("'pCDFindices' must have the same length as 'pCDFlist'!");
+    CDFindices.resize(family.numCDF);
+    for(int i = 0; i < family.numCDF; i++) {
+      CDFindices[i] = as<IntegerVector>(indices[i]);
+      family.indices[i] = CDFindices[i].begin();
+      family.counts[i] = CDFindices[i].length();
+    }
+  }
+  
+  write_store(file, family, with_indices);
+}
+
+List CDF_store_info(const std::string& file) {
+  CDF_store store(file);
+  const store_header &header = store.header();
+  
+  // indices (if any)
+  SEXP indices = R_NilValue;
+  if(store.has_indices()) {
+    CDF_family family = store.family();
+    List list(family.numCDF);
+    for(int i = 0; i < family.numCDF; i++)
+      list[i] = IntegerVector(family.indices[i], family.indices[i] + family.counts[i]);
+    indices = list;
+  }
+  
+  return List::create(
+    Named("numCDF") = (double)header.numCDF,
+    Named("numValues") = (double)header.numValues,
+    Named("pCDFindices") = indices
+  );
+}
@@ -0,0 +1,234 @@
+#ifndef DISCRETEFWER_STORE_H
+#define DISCRETEFWER_STORE_H
+
+// on-disk storage of families of p-value CDFs that are too large for memory;
+// the file is memory-mapped, so that the kernels can stream through the CDFs
+// in blocks and release the pages of processed CDFs afterwards
+//
+// file layout (native byte order):
+//   header        magic "DFWERCDF", version, flags, number of CDFs, number of
+//                 CDF values and number of indices (0, if there are none)
+//   offsets       uint64[numCDF + 1], start of each CDF in 'values'
+//   values        double[numValues], all CDFs back to back
+//   (only if flag 'STORE_INDICES' is set:)
+//   idx_offsets   uint64[numCDF + 1], start of each CDF's indices in 'indices'
+//   indices       int32[numIndices], (1-based) indices of the p-values to
+//                 which each CDF belongs
+
+#include <DiscreteFWER/core.h>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace DiscreteFWER {
+
+// flag of stores that contain indices
+const uint32_t STORE_INDICES = 1;
+
+struct store_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t flags;
+  uint64_t numCDF;
+  uint64_t numValues;
+  uint64_t numIndices;
+};
+
+// writes a family of p-value CDFs (and, if 'with_indices' is true, their
+// indices) to a store file
+inline void write_store(const std::string &file, const CDF_family &fam, const bool with_indices) {
+  store_header header;
+  std::memcpy(header.magic, "DFWERCDF", 8);
+  header.version = 1;
+  header.flags = with_indices ? STORE_INDICES : 0;
+  header.numCDF = fam.numCDF;
+
+  std::vector<uint64_t> offsets(fam.numCDF + 1, 0), idx_offsets(fam.numCDF + 1, 0);
+  for(int i = 0; i < fam.numCDF; i++) {
+    offsets[i + 1] = offsets[i] + fam.lens[i];
+    idx_offsets[i + 1] = idx_offsets[i] + (with_indices ? fam.counts[i] : 0);
+  }
+  header.numValues = offsets[fam.numCDF];
+  header.numIndices = idx_offsets[fam.numCDF];
+
+  FILE* out = std::fopen(file.c_str(), "wb");
+  if(out == NULL) throw std::runtime_error("Cannot open file '" + file + "' for writing!");
+  bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1;
+  ok = ok && std::fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), out) == offsets.size();
+  for(int i = 0; ok && i < fam.numCDF; i++)
+    ok = std::fwrite(fam.vals[i], sizeof(double), fam.lens[i], out) == (size_t)fam.lens[i];
+  if(with_indices) {
+    ok = ok && std::fwrite(idx_offsets.data(), sizeof(uint64_t), idx_offsets.size(), out) == idx_offsets.size();
+    for(int i = 0; ok && i < fam.numCDF; i++)
+      ok = std::fwrite(fam.indices[i], sizeof(int32_t), fam.counts[i], out) == (size_t)fam.counts[i];
+  }
+  ok = (std::fclose(out) == 0) && ok;
+  if(!ok) throw std::runtime_error("Writing to file '" + file + "' failed!");
+}
+
+// read-only, memory-mapped store of p-value CDFs
+class CDF_store {
+public:
+  CDF_store(const std::string &file) : data(NULL), size(0) {
+#ifdef _WIN32
+    handle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(handle == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open file '" + file + "'!");
+    LARGE_INTEGER len;
+    GetFileSizeEx(handle, &len);
+    size = (size_t)len.QuadPart;
+    mapping = size ? CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    if(mapping != NULL) data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    fd = open(file.c_str(), O_RDONLY);
+    if(fd < 0) throw std::runtime_error("Cannot open file '" + file + "'!");
+    struct stat st;
+    if(fstat(fd, &st) == 0) size = (size_t)st.st_size;
+    if(size) {
+      void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+      if(map != MAP_FAILED) {
+        data = (const char*)map;
+        // CDFs are read sequentially
+        madvise(map, size, MADV_SEQUENTIAL);
+      }
+    }
+#endif
+    if(data == NULL || !valid()) {
+      close_map();
+      throw std::runtime_error("File '" + file + "' is not a valid store of p-value CDFs!");
+    }
+  }
+
+  ~CDF_store() { close_map(); }
+
+  // header of the store
+  inline const store_header& header() const { return *(const store_header*)data; }
+
+  // number of CDFs
+  inline int numCDF() const { return (int)header().numCDF; }
+
+  // whether the store contains indices
+  inline bool has_indices() const { return header().flags & STORE_INDICES; }
+
+  // R-independent view of the CDFs (with counts and indices, if available)
+  inline CDF_family family() const {
+    int n = numCDF();
+    CDF_family fam(n);
+    for(int i = 0; i < n; i++) {
+      // the lengths are those of the offsets, as only CDFs without values
+      // > 1 are written; hence, no values are read before the kernels stream
+      // through them
+      fam.vals[i] = values() + offsets()[i];
+      fam.lens[i] = (int)(offsets()[i + 1] - offsets()[i]);
+      if(has_indices()) {
+        fam.indices[i] = indices() + idx_offsets()[i];
+        fam.counts[i] = (int)(idx_offsets()[i + 1] - idx_offsets()[i]);
+      } else fam.counts[i] = 1;
+    }
+    return fam;
+  }
+
+  // releases the pages of the values of the CDFs 'from', ..., 'to - 1', as
+  // they are no longer needed (they are re-read, if they are accessed again)
+  inline void release(const int from, const int to) const {
+#ifndef _WIN32
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t a = (size_t)((const char*)(values() + offsets()[from]) - data);
+    size_t b = (size_t)((const char*)(values() + offsets()[to]) - data);
+    // only whole pages within the range can be released
+    a = (a + page - 1) / page * page;
+    b = b / page * page;
+    if(a < b) madvise((void*)(data + a), b - a, MADV_DONTNEED);
+#else
+    (void)from; (void)to;
+#endif
+  }
+
+private:
+  // checks header and file size, that the offsets of the CDFs and of their
+  // indices are increasing and within the file, i.e. that no CDF and no
+  // index set is empty, and that the indices are a partition of the p-values
+  inline bool valid() const {
+    if(size < sizeof(store_header)) return false;
+    const store_header &h = header();
+    if(std::memcmp(h.magic, "DFWERCDF", 8) != 0 || h.version != 1) return false;
+    // sizes must not overflow the computation of the expected file size
+    if(h.numCDF < 1 || h.numCDF > (uint64_t)INT_MAX || h.numValues > size || h.numIndices > (uint64_t)INT_MAX) return false;
+    uint64_t expected = sizeof(store_header) + (h.numCDF + 1) * sizeof(uint64_t) + h.numValues * sizeof(double);
+    if(h.flags & STORE_INDICES)
+      expected += (h.numCDF + 1) * sizeof(uint64_t) + h.numIndices * sizeof(int32_t);
+    if(expected != size) return false;
+
+    const uint64_t* off = offsets();
+    if(off[0] != 0 || off[h.numCDF] != h.numValues) return false;
+    for(uint64_t i = 0; i < h.numCDF; i++)
+      if(off[i + 1] <= off[i] || off[i + 1] - off[i] > (uint64_t)INT_MAX) return false;
+    if(!(h.flags & STORE_INDICES)) return true;
+
+    const uint64_t* idx_off = idx_offsets();
+    if(idx_off[0] != 0 || idx_off[h.numCDF] != h.numIndices) return false;
+    for(uint64_t i = 0; i < h.numCDF; i++)
+      if(idx_off[i + 1] <= idx_off[i]) return false;
+    const int32_t* idx = indices();
+    std::vector<bool> seen(h.numIndices, false);
+    for(uint64_t k = 0; k < h.numIndices; k++) {
+      if(idx[k] < 1 || (uint64_t)idx[k] > h.numIndices || seen[idx[k] - 1]) return false;
+      seen[idx[k] - 1] = true;
+    }
+    return true;
+  }
+
+  inline const uint64_t* offsets() const {
+    return (const uint64_t*)(data + sizeof(store_header));
+  }
+  inline const double* values() const {
+    return (const double*)(offsets() + header().numCDF + 1);
+  }
+  inline const uint64_t* idx_offsets() const {
+    return (const uint64_t*)(values() + header().numValues);
+  }
+  inline const int32_t* indices() const {
+    return (const int32_t*)(idx_offsets() + header().numCDF + 1);
+  }
+
+  inline void close_map() {
+#ifdef _WIN32
+    if(data != NULL) UnmapViewOfFile(data);
+    if(mapping != NULL) CloseHandle(mapping);
+    if(handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+    mapping = NULL;
+    handle = INVALID_HANDLE_VALUE;
+#else
+    if(data != NULL) munmap((void*)data, size);
+    if(fd >= 0) close(fd);
+    fd = -1;
+#endif
+    data = NULL;
+  }
+
+  const char* data;
+  size_t size;
+#ifdef _WIN32
+  HANDLE handle;
+  HANDLE mapping;
+#else
+  int fd;
+#endif
+};
+
+} // namespace DiscreteFWER
+
+#endif